@@ -0,0 +1,125 @@
+/**
+ * @file ChangeDetector.hpp
+ * @author Guo1ZY 132872017@qq.com
+ * @brief 分块变化检测
+ * @version 0.1
+ * @date 2025-01-15
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef CHANGE_DETECTOR_HPP
+#define CHANGE_DETECTOR_HPP
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief 分块变化检测器
+ *
+ * 每帧与参考帧的彩色和深度图像逐块 (16x16或32x32) 计算SIMD绝对差之和，
+ * 按滞回阈值生成变化掩码: 块的平均绝对差超过高阈值时标记为变化，
+ * 降到低阈值以下才恢复为未变化。下游处理可据此跳过未变化的块。
+ * 参考帧只在变化块内刷新，每块始终与上次报告变化时的内容比较，
+ * 因此逐帧低于阈值的缓慢漂移累积到阈值后同样会被标记。
+ */
+class ChangeDetector
+{
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param tileSize 块边长(像素)，按深度图像 (无深度时按彩色图像) 划分
+     */
+    explicit ChangeDetector(int tileSize = 32);
+
+    /**
+     * @brief 设置滞回阈值 (块内每像素平均绝对差)
+     *
+     * @param depthHigh 深度高阈值(深度单位，通常为毫米)
+     * @param depthLow 深度低阈值
+     * @param colorHigh 彩色高阈值(灰度级，按通道平均)
+     * @param colorLow 彩色低阈值
+     */
+    void setThresholds(float depthHigh, float depthLow, float colorHigh, float colorLow);
+
+    /**
+     * @brief 输入新一帧并更新变化掩码
+     *
+     * @param colorImg 彩色图像 (CV_8UC3)，为空时不参与比较
+     * @param depthImg 深度图像 (CV_16UC1)，为空时不参与比较
+     * @return const cv::Mat& 变化掩码 (CV_8UC1，每个元素对应一个块，255表示变化)
+     */
+    const cv::Mat &update(const cv::Mat &colorImg, const cv::Mat &depthImg);
+
+    /**
+     * @brief 获取最近一次的变化掩码
+     *
+     * @return const cv::Mat& 变化掩码
+     */
+    const cv::Mat &getMask() const;
+
+    /**
+     * @brief 设置块边长，并清空历史帧
+     *
+     * @param tileSize 块边长(像素)
+     */
+    void setTileSize(int tileSize);
+
+    /**
+     * @brief 获取块边长
+     *
+     * @return int 块边长(像素)
+     */
+    int getTileSize() const;
+
+    /**
+     * @brief 获取变化块占比
+     *
+     * @return float 变化块数 / 总块数
+     */
+    float getChangedRatio() const;
+
+    /**
+     * @brief 清空历史帧，下一帧全部视为变化
+     */
+    void reset();
+
+private:
+    int tileSize;
+    float depthHigh;
+    float depthLow;
+    float colorHigh;
+    float colorLow;
+
+    // 参考帧: 每块为最近一次标记变化时的内容 (复用缓冲)
+    cv::Mat previousColor;
+    cv::Mat previousDepth;
+
+    // 每块平均绝对差 (CV_32FC1) 与变化掩码
+    cv::Mat depthDiff;
+    cv::Mat colorDiff;
+    cv::Mat mask;
+    int changedCount;
+
+    /**
+     * @brief 逐块计算平均绝对差
+     *
+     * @param current 当前图像
+     * @param previous 参考帧
+     * @param referenceSize 划分块网格所用的图像尺寸，当前图像尺寸不同时按比例映射
+     * @param tileDiff 输出每块平均绝对差 (尺寸与掩码一致)
+     */
+    void computeTileDiff(const cv::Mat &current, const cv::Mat &previous, const cv::Size &referenceSize, cv::Mat &tileDiff) const;
+
+    /**
+     * @brief 将变化块的当前像素写入参考帧
+     *
+     * @param current 当前图像
+     * @param previous 参考帧
+     * @param valid 参考帧是否与当前图像同尺寸，否则整帧保存
+     * @param referenceSize 划分块网格所用的图像尺寸
+     */
+    void updateReference(const cv::Mat &current, cv::Mat &previous, bool valid, const cv::Size &referenceSize) const;
+};
+
+#endif // CHANGE_DETECTOR_HPP
@@ -0,0 +1,85 @@
+/**
+ * @file DepthCodec.hpp
+ * @author Guo1ZY 132872017@qq.com
+ * @brief 深度图无损编解码 (RVL)
+ * @version 0.1
+ * @date 2025-01-15
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef DEPTH_CODEC_HPP
+#define DEPTH_CODEC_HPP
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 16位深度图无损编解码器
+ *
+ * 采用RVL (Run length Variable Length) 算法: 零值游程编码 + 相邻有效像素差分 +
+ * 4bit变长整数。640x480深度图单核编码约1~2ms、解码约1ms，与PNG的对比见depth_codec_benchmark。
+ * 编解码器内部缓冲区在多帧之间复用，稳态下不再分配内存。
+ */
+class DepthCodec
+{
+public:
+    DepthCodec();
+
+    /**
+     * @brief 编码深度图
+     *
+     * @param depthImg 输入深度图 (CV_16UC1)
+     * @param output 输出码流 (包含宽高头信息)，其容量会被复用
+     * @return bool 是否成功
+     */
+    bool encode(const cv::Mat &depthImg, std::vector<uint8_t> &output);
+
+    /**
+     * @brief 解码深度图
+     *
+     * @param data 码流数据
+     * @param size 码流长度
+     * @param depthImg 输出深度图 (CV_16UC1)，尺寸一致时复用其内存
+     * @return bool 是否成功
+     */
+    bool decode(const uint8_t *data, size_t size, cv::Mat &depthImg);
+
+    /**
+     * @brief 解码深度图
+     *
+     * @param input 码流数据
+     * @param depthImg 输出深度图 (CV_16UC1)
+     * @return bool 是否成功
+     */
+    bool decode(const std::vector<uint8_t> &input, cv::Mat &depthImg);
+
+    /**
+     * @brief 编码深度图并保存为文件 (.rvl)
+     *
+     * @param filename 文件名
+     * @param depthImg 输入深度图 (CV_16UC1)
+     * @return bool 是否成功
+     */
+    bool save(const std::string &filename, const cv::Mat &depthImg);
+
+    /**
+     * @brief 从文件读取并解码深度图
+     *
+     * @param filename 文件名
+     * @param depthImg 输出深度图 (CV_16UC1)
+     * @return bool 是否成功
+     */
+    bool load(const std::string &filename, cv::Mat &depthImg);
+
+private:
+    // 文件读写复用的码流缓冲
+    std::vector<uint8_t> streamBuffer;
+
+    // 非连续输入的复用拷贝缓冲
+    cv::Mat continuousBuffer;
+};
+
+#endif // DEPTH_CODEC_HPP
@@ -0,0 +1,168 @@
+/**
+ * @file FrameHistory.hpp
+ * @author Guo1ZY 132872017@qq.com
+ * @brief 按内存预算的帧历史环形缓冲与事件触发保存
+ * @version 0.1
+ * @date 2025-01-15
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef FRAME_HISTORY_HPP
+#define FRAME_HISTORY_HPP
+
+#include "DepthCodec.hpp"
+#include <libobsensor/ObSensor.hpp>
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 帧历史环形缓冲
+ *
+ * 始终保存最近一段时间的原始帧集: 彩色为压缩JPEG (MJPG直接拷贝)，深度和红外为原始数据。
+ * 所有槽位在构造时按字节预算一次性分配，稳态下推入帧不再分配内存。
+ * 调用trigger()后，事件前后的帧被锁定并交给后台线程写盘，写完后槽位重新参与循环。
+ */
+class FrameHistory
+{
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param budgetBytes 内存预算(字节)，决定槽位数量
+     * @param colorCapacity 单帧压缩彩色数据容量(字节)，超出的帧不保存彩色
+     * @param depthCapacity 单帧深度数据容量(字节)
+     * @param irCapacity 单帧红外数据容量(字节)
+     */
+    FrameHistory(size_t budgetBytes, size_t colorCapacity, size_t depthCapacity, size_t irCapacity);
+    ~FrameHistory();
+
+    /**
+     * @brief 推入一帧帧集，跳过被事件锁定的槽位，全部槽位都被锁定时丢弃
+     *
+     * @param frameset 帧集
+     */
+    void push(std::shared_ptr<ob::FrameSet> frameset);
+
+    /**
+     * @brief 触发事件保存
+     *
+     * 锁定的事件前帧数量受空闲槽位限制: 先为事件后的帧预留槽位，不足时只保留最近的事件前帧。
+     *
+     * @param preSeconds 保存事件前的时长(秒)
+     * @param postSeconds 保存事件后的时长(秒)
+     * @param prefix 输出文件名前缀
+     * @return bool 是否成功触发 (上一个事件尚未结束或空闲槽位不足以容纳事件后的帧时返回false)
+     */
+    bool trigger(double preSeconds, double postSeconds, const std::string &prefix);
+
+    /**
+     * @brief 获取槽位数量
+     *
+     * @return size_t 槽位数量
+     */
+    size_t getSlotCount() const;
+
+    /**
+     * @brief 获取当前缓冲覆盖的时长
+     *
+     * @return double 时长(秒)
+     */
+    double getBufferedSeconds() const;
+
+    /**
+     * @brief 获取因槽位被锁定或容量不足而丢弃的帧数
+     *
+     * @return uint64_t 丢弃帧数
+     */
+    uint64_t getDroppedCount() const;
+
+private:
+    /**
+     * @brief 槽位
+     */
+    struct Slot
+    {
+        uint64_t sequence;  // 推入序号，0表示空槽
+        uint64_t timestampUs;
+        bool pinned;        // 已被事件锁定，等待写盘
+
+        std::vector<uint8_t> color;
+        size_t colorSize;
+
+        std::vector<uint8_t> depth;
+        int depthWidth;
+        int depthHeight;
+
+        std::vector<uint8_t> ir;
+        int irWidth;
+        int irHeight;
+    };
+
+    /**
+     * @brief 写盘任务
+     */
+    struct Job
+    {
+        std::string prefix;
+        std::vector<size_t> slots;
+    };
+
+    std::vector<Slot> slots;
+    size_t head;
+    uint64_t sequence;
+    uint64_t droppedCount;
+
+    // 进行中的事件
+    bool eventActive;
+    uint64_t eventEndUs;
+    Job eventJob;
+
+    // 后台写盘线程
+    mutable std::mutex mutex;
+    std::condition_variable jobReady;
+    std::deque<Job> jobs;
+    bool stopping;
+    std::thread writerThread;
+
+    // 非MJPG彩色帧的编码缓冲 (复用)
+    cv::Mat colorBuffer;
+    std::vector<uchar> encodeBuffer;
+    std::vector<int> encodeParams;
+
+    // 写盘线程使用的深度编码器
+    DepthCodec depthCodec;
+
+    /**
+     * @brief 将彩色帧压缩保存到槽位
+     *
+     * @return bool 是否保存成功
+     */
+    bool storeColor(Slot &slot, std::shared_ptr<ob::ColorFrame> colorFrame);
+
+    /**
+     * @brief 将原始帧数据拷贝到槽位
+     *
+     * @return bool 是否保存成功
+     */
+    static bool storeRaw(std::vector<uint8_t> &buffer, int &width, int &height, std::shared_ptr<ob::VideoFrame> frame);
+
+    /**
+     * @brief 后台写盘线程
+     */
+    void writerLoop();
+
+    /**
+     * @brief 保存一个槽位到文件
+     */
+    void writeSlot(const Slot &slot, const std::string &prefix, size_t index);
+};
+
+#endif // FRAME_HISTORY_HPP
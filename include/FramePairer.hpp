@@ -0,0 +1,146 @@
+/**
+ * @file FramePairer.hpp
+ * @author Guo1ZY 132872017@qq.com
+ * @brief 基于时间戳的彩色/深度帧配对
+ * @version 0.1
+ * @date 2025-01-15
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef FRAME_PAIRER_HPP
+#define FRAME_PAIRER_HPP
+
+#include <libobsensor/ObSensor.hpp>
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+/**
+ * @brief 配对模式
+ */
+enum class PairMode
+{
+    WaitForMatch, // 等待时间戳差在容差内的配对，直到超时
+    BestEffort    // 立即返回当前缓冲中时间戳最接近的配对
+};
+
+/**
+ * @brief 彩色/深度帧时间差统计 (微秒，正值表示彩色帧晚于深度帧)
+ */
+struct FrameSkewStats
+{
+    uint64_t pairCount;           // 输出的配对总数
+    uint64_t outOfToleranceCount; // 超出容差仍被输出的配对数 (BestEffort)
+    uint64_t droppedColorCount;   // 未配对即被丢弃的彩色帧数
+    uint64_t droppedDepthCount;   // 未配对即被丢弃的深度帧数
+    int64_t lastSkewUs;           // 最近一次配对的时间差
+    int64_t minSkewUs;            // 最小时间差
+    int64_t maxSkewUs;            // 最大时间差
+    double meanSkewUs;            // 平均时间差
+    double stddevSkewUs;          // 时间差标准差
+    double meanAbsSkewUs;         // 平均绝对时间差
+};
+
+/**
+ * @brief 彩色/深度帧配对器
+ *
+ * 按流缓存最近若干帧，依据设备时间戳将彩色帧与深度帧配对，
+ * 避免SDK在高负载下输出缺流或时间错位的帧集时配对错误。
+ */
+class FramePairer
+{
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param capacity 每个流缓存的最大帧数
+     * @param toleranceUs 配对容差(微秒)
+     */
+    FramePairer(size_t capacity = 8, uint64_t toleranceUs = 16000);
+
+    /**
+     * @brief 设置配对容差
+     *
+     * @param toleranceUs 容差(微秒)
+     */
+    void setTolerance(uint64_t toleranceUs);
+
+    /**
+     * @brief 获取配对容差
+     *
+     * @return uint64_t 容差(微秒)
+     */
+    uint64_t getTolerance() const;
+
+    /**
+     * @brief 将帧集中的彩色帧和深度帧加入缓存
+     *
+     * @param frameset 帧集，可缺少任意流
+     */
+    void push(std::shared_ptr<ob::FrameSet> frameset);
+
+    /**
+     * @brief 取出容差内时间差最小的配对
+     *
+     * @param colorFrame 输出的彩色帧
+     * @param depthFrame 输出的深度帧
+     * @return bool 是否存在容差内的配对
+     */
+    bool pop(std::shared_ptr<ob::ColorFrame> &colorFrame, std::shared_ptr<ob::DepthFrame> &depthFrame);
+
+    /**
+     * @brief 取出当前缓存中时间差最小的配对 (不限容差)
+     *
+     * @param colorFrame 输出的彩色帧
+     * @param depthFrame 输出的深度帧
+     * @return bool 两个流是否都有缓存帧
+     */
+    bool popBest(std::shared_ptr<ob::ColorFrame> &colorFrame, std::shared_ptr<ob::DepthFrame> &depthFrame);
+
+    /**
+     * @brief 清空缓存
+     */
+    void clear();
+
+    /**
+     * @brief 获取时间差统计
+     *
+     * @return FrameSkewStats 统计信息
+     */
+    FrameSkewStats getStats() const;
+
+    /**
+     * @brief 重置时间差统计
+     */
+    void resetStats();
+
+private:
+    size_t capacity;
+    uint64_t toleranceUs;
+
+    std::deque<std::shared_ptr<ob::ColorFrame>> colorQueue;
+    std::deque<std::shared_ptr<ob::DepthFrame>> depthQueue;
+
+    // 统计量 (Welford在线方差)
+    FrameSkewStats stats;
+    double skewM2;
+
+    /**
+     * @brief 查找时间差最小的配对
+     *
+     * @param colorIndex 输出的彩色帧下标
+     * @param depthIndex 输出的深度帧下标
+     * @param skewUs 输出的时间差
+     * @return bool 是否找到
+     */
+    bool findClosest(size_t &colorIndex, size_t &depthIndex, int64_t &skewUs) const;
+
+    /**
+     * @brief 取出指定配对，并丢弃两个流中更早的帧
+     */
+    void take(size_t colorIndex, size_t depthIndex, int64_t skewUs,
+              std::shared_ptr<ob::ColorFrame> &colorFrame, std::shared_ptr<ob::DepthFrame> &depthFrame);
+};
+
+#endif // FRAME_PAIRER_HPP
@@ -0,0 +1,208 @@
+/**
+ * @file FramePipeline.hpp
+ * @author Guo1ZY 132872017@qq.com
+ * @brief 逐帧流水线处理: 阶段图在共享线程池上并行执行
+ * @version 0.1
+ * @date 2025-01-15
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef FRAME_PIPELINE_HPP
+#define FRAME_PIPELINE_HPP
+
+#include "ThreadPool.hpp"
+#include "VirtualScan.hpp"
+#include <libobsensor/ObSensor.hpp>
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 阶段执行方式
+ */
+enum class StageMode
+{
+    Serial,  // 一次处理一帧并严格按帧序，适用于有跨帧状态或非线程安全的阶段
+    Parallel // 多帧同时处理，适用于无状态阶段
+};
+
+/**
+ * @brief 在阶段之间传递的一帧数据
+ *
+ * 内置阶段可能直接引用帧集内存 (如深度、红外图像)，这些图像只在本结构体存活期间有效，
+ * 需要长期保存时请clone。
+ */
+struct FramePacket
+{
+    uint64_t sequence;                      // 帧序号，从0开始连续递增
+    std::shared_ptr<ob::FrameSet> frameset; // 原始帧集
+    cv::Mat color;                          // 彩色图像 (BGR)
+    cv::Mat depth;                          // 深度图像 (CV_16UC1)
+    cv::Mat ir;                             // 红外图像 (CV_16UC1)
+    cv::Mat changeMask;                     // 变化掩码 (CV_8UC1，每个元素对应一个块)
+    int changeTileSize;                     // 变化掩码的块边长(像素)
+    cv::Mat pointCloud;                     // 有序点云 (CV_32FC3，米)
+    LaserScan scan;                         // 虚拟激光扫描
+    std::map<std::string, cv::Mat> user;    // 用户阶段的输出
+};
+
+/**
+ * @brief 单个阶段的运行统计
+ */
+struct StageStats
+{
+    std::string name;
+    StageMode mode;
+    size_t queueDepth;  // 等待该阶段处理的帧数
+    size_t active;      // 正在处理的帧数
+    uint64_t processed; // 已处理帧数
+    double meanTimeMs;  // 平均每帧处理时间(毫秒)
+    double occupancy;   // 占用率: 处理时间总和/运行时间，即平均占用线程数
+};
+
+/**
+ * @brief 逐帧流水线
+ *
+ * 阶段按添加顺序串联，每帧依次经过所有阶段; 不同帧在线程池上同时处于不同阶段，
+ * 并行阶段还可同时处理多帧，因此单帧总耗时超过帧间隔时仍能保持传感器帧率。
+ * 输出按帧序重排，pop得到的帧顺序与push一致。在途帧数达到上限时push阻塞。
+ */
+class FramePipeline
+{
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param threadCount 线程数，0表示使用硬件线程数
+     * @param maxInFlight 在途帧数上限 (含已完成未取出的帧)，0表示线程数的2倍加2
+     */
+    explicit FramePipeline(size_t threadCount = 0, size_t maxInFlight = 0);
+
+    /**
+     * @brief 析构函数，等待在途帧处理完成
+     */
+    ~FramePipeline();
+
+    /**
+     * @brief 添加阶段 (需在第一次push之前调用)
+     *
+     * @param name 阶段名称
+     * @param process 处理函数，就地修改帧数据
+     * @param mode 执行方式
+     * @return bool 是否成功添加
+     */
+    bool addStage(const std::string &name, std::function<void(FramePacket &)> process, StageMode mode = StageMode::Parallel);
+
+    /**
+     * @brief 推入一帧帧集
+     *
+     * @param frameset 帧集
+     * @param timeoutMs 在途帧数达到上限时的最长等待时间(毫秒)
+     * @return bool 是否推入，超时则丢弃该帧
+     */
+    bool push(std::shared_ptr<ob::FrameSet> frameset, uint32_t timeoutMs = 1000);
+
+    /**
+     * @brief 按帧序取出一帧处理结果
+     *
+     * @param packet 输出的帧数据
+     * @param timeoutMs 最长等待时间(毫秒)，0表示不等待
+     * @return bool 是否取得
+     */
+    bool pop(FramePacket &packet, uint32_t timeoutMs = 0);
+
+    /**
+     * @brief 等待所有已推入的帧处理完成
+     */
+    void flush();
+
+    /**
+     * @brief 获取各阶段运行统计
+     *
+     * @return std::vector<StageStats> 按阶段顺序排列的统计信息
+     */
+    std::vector<StageStats> getStats() const;
+
+    /**
+     * @brief 获取因在途帧数达到上限而丢弃的帧数
+     *
+     * @return uint64_t 丢弃帧数
+     */
+    uint64_t getDroppedCount() const;
+
+    /**
+     * @brief 获取在途帧数上限，阶段可据此确定输出缓冲池容量
+     *
+     * @return size_t 在途帧数上限
+     */
+    size_t getMaxInFlight() const;
+
+private:
+    /**
+     * @brief 阶段状态，队列按帧序排列
+     */
+    struct Stage
+    {
+        std::string name;
+        std::function<void(FramePacket &)> process;
+        StageMode mode;
+
+        mutable std::mutex mutex;
+        std::map<uint64_t, std::shared_ptr<FramePacket>> queue;
+        uint64_t nextSequence; // 串行阶段下一个应处理的帧序号
+        size_t active;
+        uint64_t processed;
+        double busyMs;
+    };
+
+    std::vector<std::unique_ptr<Stage>> stages;
+
+    // 输出重排与在途帧计数
+    mutable std::mutex outputMutex;
+    std::condition_variable outputReady;
+    std::condition_variable slotFree;
+    std::map<uint64_t, std::shared_ptr<FramePacket>> reorder;
+    std::deque<std::shared_ptr<FramePacket>> output;
+    uint64_t nextSequence;
+    uint64_t nextOutput;
+    size_t processing; // 已推入但未进入输出队列的帧数
+    size_t inFlight;   // processing + 输出队列长度
+    size_t maxInFlight;
+    uint64_t droppedCount;
+    bool started;
+    std::chrono::steady_clock::time_point startTime;
+
+    // 线程池最后声明，析构时先于其他成员停止
+    ThreadPool pool;
+
+    /**
+     * @brief 将帧放入指定阶段的队列 (超出最后一个阶段则进入输出)
+     */
+    void enqueue(size_t stageIndex, std::shared_ptr<FramePacket> packet);
+
+    /**
+     * @brief 从阶段队列中取出可执行的帧提交到线程池
+     */
+    void schedule(size_t stageIndex);
+
+    /**
+     * @brief 执行一个阶段并转入下一阶段
+     */
+    void run(size_t stageIndex, std::shared_ptr<FramePacket> packet);
+
+    /**
+     * @brief 按帧序放入输出队列
+     */
+    void deliver(std::shared_ptr<FramePacket> packet);
+};
+
+#endif // FRAME_PIPELINE_HPP
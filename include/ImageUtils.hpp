@@ -0,0 +1,73 @@
+/**
+ * @file ImageUtils.hpp
+ * @author Guo1ZY 132872017@qq.com
+ * @brief 图像缓冲池与相机内参缩放
+ * @version 0.1
+ * @date 2025-01-15
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef IMAGE_UTILS_HPP
+#define IMAGE_UTILS_HPP
+
+#include <libobsensor/ObSensor.hpp>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+/**
+ * @brief 按图像分辨率缩放相机内参 (内参标定分辨率与图像分辨率不同时)
+ *
+ * @param intrinsic 相机内参
+ * @param imageSize 图像尺寸
+ * @return OBCameraIntrinsic 缩放后的内参，宽高为图像尺寸
+ */
+OBCameraIntrinsic scaleIntrinsic(const OBCameraIntrinsic &intrinsic, const cv::Size &imageSize);
+
+/**
+ * @brief 图像缓冲池
+ *
+ * 输出图像直接交给调用方，调用方释放后 (引用计数回到只有缓冲池持有) 再次复用，
+ * 稳定运行时不再分配内存。池满且没有空闲缓冲时直接分配，不再入池。
+ */
+class BufferPool
+{
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param capacity 缓冲池最大容量
+     */
+    explicit BufferPool(size_t capacity = 4);
+
+    /**
+     * @brief 设置缓冲池最大容量，应不小于同时被外部持有的缓冲数量
+     *
+     * @param capacity 最大容量
+     */
+    void setCapacity(size_t capacity);
+
+    /**
+     * @brief 取出未被外部引用的缓冲区
+     *
+     * @param size 图像尺寸
+     * @param type 图像类型
+     * @return cv::Mat 缓冲区
+     */
+    cv::Mat acquire(const cv::Size &size, int type);
+
+    /**
+     * @brief 缓冲是否除缓冲池外只被调用方持有 (下游已释放)
+     *
+     * @param buffer 由acquire取出的缓冲区
+     * @param callerRefs 调用方持有的引用数 (含参数buffer本身)
+     * @return bool 是否可由调用方原地修改
+     */
+    bool isIdle(const cv::Mat &buffer, int callerRefs) const;
+
+private:
+    size_t capacity;
+    std::vector<cv::Mat> buffers;
+};
+
+#endif // IMAGE_UTILS_HPP
@@ -11,6 +11,13 @@
 #ifndef ORBBEC_DABAI_HPP
 #define ORBBEC_DABAI_HPP
 
+#include "ChangeDetector.hpp"
+#include "FrameHistory.hpp"
+#include "FramePairer.hpp"
+#include "FramePipeline.hpp"
+#include "TsdfVolume.hpp"
+#include "Undistorter.hpp"
+#include "VirtualScan.hpp"
 #include <libobsensor/ObSensor.hpp>
 #include <opencv2/opencv.hpp>
 #include <string>
@@ -41,47 +48,190 @@ public:
     /**
      * @brief 获取图像 (彩色、深度、红外)
      *
+     * @param undistort 是否输出去畸变图像
      * @return std::vector<cv::Mat> [0]彩色图像 [1]深度图像 [2]红外图像
      */
-    std::vector<cv::Mat> getImg();
+    std::vector<cv::Mat> getImg(bool undistort = false);
 
     /**
      * @brief 获取彩色图像
      *
+     * @param undistort 是否输出去畸变图像
      * @return cv::Mat 彩色图像
      */
-    cv::Mat getColorImg();
+    cv::Mat getColorImg(bool undistort = false);
 
     /**
      * @brief 获取深度图像
      *
+     * @param undistort 是否输出去畸变图像
      * @return cv::Mat 深度图像
      */
-    cv::Mat getDepthImg();
+    cv::Mat getDepthImg(bool undistort = false);
 
     /**
      * @brief 获取红外图像
      *
+     * @param undistort 是否输出去畸变图像
      * @return cv::Mat 红外图像
      */
-    cv::Mat getIRImg();
+    cv::Mat getIRImg(bool undistort = false);
 
     /**
      * @brief 获取指定像素点的深度值
      *
      * @param x 像素x坐标
      * @param y 像素y坐标
+     * @param undistort 坐标是否为去畸变图像坐标
      * @return float 深度值(米)，0表示无效深度
      */
-    float getDepthAt(int x, int y);
+    float getDepthAt(int x, int y, bool undistort = false);
 
     /**
      * @brief 获取对齐的彩色图像和深度图像
      *
      * @param colorImg 输出的彩色图像
      * @param depthImg 输出的深度图像
+     * @param undistort 是否输出去畸变图像
      */
-    void getAlignedImages(cv::Mat &colorImg, cv::Mat &depthImg);
+    void getAlignedImages(cv::Mat &colorImg, cv::Mat &depthImg, bool undistort = false);
+
+    /**
+     * @brief 设置彩色/深度帧配对方式 (用于getAlignedImages)
+     *
+     * @param mode 配对模式
+     * @param toleranceUs 时间戳容差(微秒)
+     * @param timeoutMs WaitForMatch模式下的最长等待时间(毫秒)
+     */
+    void setFramePairing(PairMode mode, uint64_t toleranceUs = 16000, uint32_t timeoutMs = 200);
+
+    /**
+     * @brief 获取彩色/深度帧时间差统计
+     *
+     * @return FrameSkewStats 统计信息
+     */
+    FrameSkewStats getFrameSkewStats() const;
+
+    /**
+     * @brief 获取相机内参和畸变系数
+     *
+     * @param param 输出的相机参数
+     * @return bool 是否成功
+     */
+    bool getCameraParam(OBCameraParam &param) const;
+
+    /**
+     * @brief 获取一帧对齐的彩色和深度图像并融合到TSDF体积
+     *
+     * @param volume TSDF体积 (变化检测通过TsdfVolume::setChangeDetection单独开启)
+     * @param cameraPose 相机到世界坐标系的位姿
+     * @return bool 是否成功
+     */
+    bool integrateTsdf(TsdfVolume &volume, const cv::Matx44f &cameraPose = cv::Matx44f::eye());
+
+    /**
+     * @brief 开启或关闭分块变化检测
+     *
+     * @param enable 是否开启
+     * @param tileSize 块边长(像素)，建议16或32
+     */
+    void setChangeDetection(bool enable, int tileSize = 32);
+
+    /**
+     * @brief 设置变化检测滞回阈值 (块内每像素平均绝对差)
+     *
+     * @param depthHigh 深度高阈值(毫米)
+     * @param depthLow 深度低阈值(毫米)
+     * @param colorHigh 彩色高阈值(灰度级)
+     * @param colorLow 彩色低阈值(灰度级)
+     */
+    void setChangeThresholds(float depthHigh, float depthLow, float colorHigh, float colorLow);
+
+    /**
+     * @brief 获取最近一次取图对应的变化掩码 (与同一接口的参考帧比较)
+     *
+     * @return cv::Mat 变化掩码 (CV_8UC1，每个元素对应一个块，255表示变化)，未开启时为空
+     */
+    cv::Mat getChangeMask() const;
+
+    /**
+     * @brief 开启帧历史环形缓冲 (需在init之后调用)
+     *
+     * @param budgetBytes 内存预算(字节)，0表示关闭
+     */
+    void enableHistory(size_t budgetBytes);
+
+    /**
+     * @brief 触发事件保存: 将事件前后的原始帧交给后台线程写盘
+     *
+     * @param preSeconds 保存事件前的时长(秒)
+     * @param postSeconds 保存事件后的时长(秒)
+     * @param prefix 输出文件名前缀
+     * @return bool 是否成功触发
+     */
+    bool trigger(double preSeconds, double postSeconds, const std::string &prefix = "event");
+
+    /**
+     * @brief 获取一帧深度并转换为虚拟激光扫描
+     *
+     * @param scanner 虚拟扫描转换器 (查找表在多帧之间复用)
+     * @param scan 输出扫描数据
+     * @return bool 是否成功
+     */
+    bool getLaserScan(VirtualScan &scanner, LaserScan &scan);
+
+    /**
+     * @brief 获取一帧帧集并推入流水线，取帧线程只负责取帧，处理在线程池上进行
+     *
+     * @param pipeline 流水线
+     * @param timeoutMs 取帧及等待流水线空位的超时时间(毫秒)
+     * @return bool 是否成功推入
+     */
+    bool feedPipeline(FramePipeline &pipeline, uint32_t timeoutMs = 1000);
+
+    /**
+     * @brief 添加格式转换阶段 (并行): 彩色解码为BGR，深度和红外直接引用帧集内存
+     *
+     * @param pipeline 流水线
+     * @return bool 是否成功添加
+     */
+    bool addConvertStage(FramePipeline &pipeline);
+
+    /**
+     * @brief 添加去畸变阶段 (串行)，阶段使用自己的去畸变器，可与取图接口同时使用
+     *
+     * @param pipeline 流水线
+     * @return bool 是否成功添加
+     */
+    bool addUndistortStage(FramePipeline &pipeline);
+
+    /**
+     * @brief 添加分块变化检测阶段 (串行)，结果写入changeMask和changeTileSize
+     *
+     * @param pipeline 流水线
+     * @param detector 该阶段专用的变化检测器，参考帧为上一个经过该阶段的帧，需在流水线存活期间保持有效
+     * @return bool 是否成功添加
+     */
+    bool addChangeDetectionStage(FramePipeline &pipeline, ChangeDetector &detector);
+
+    /**
+     * @brief 添加有序点云阶段 (串行)，结果写入pointCloud
+     *
+     * 前面有变化检测阶段时只重算变化块，未变化块沿用上一帧点云; 输出缓冲在多帧之间复用
+     *
+     * @param pipeline 流水线
+     * @return bool 是否成功添加
+     */
+    bool addPointCloudStage(FramePipeline &pipeline);
+
+    /**
+     * @brief 添加虚拟激光扫描阶段 (串行)，结果写入scan
+     *
+     * @param pipeline 流水线
+     * @param scanner 虚拟扫描转换器，需在流水线存活期间保持有效
+     * @return bool 是否成功添加
+     */
+    bool addLaserScanStage(FramePipeline &pipeline, VirtualScan &scanner);
 
 private:
     // Orbbec SDK相关对象
@@ -102,6 +252,8 @@ private:
     int colorHeight;
     int depthWidth;
     int depthHeight;
+    int irWidth;
+    int irHeight;
 
     // 深度缩放因子
     float depthScale;
@@ -109,6 +261,36 @@ private:
     // 最新的帧集
     std::shared_ptr<ob::FrameSet> currentFrameset;
 
+    // 彩色/深度帧配对
+    FramePairer framePairer;
+    PairMode pairMode;
+    uint32_t pairTimeoutMs;
+
+    // 相机内参和畸变系数
+    OBCameraParam cameraParam;
+    bool hasCameraParam;
+
+    // 分块变化检测: 每个取图接口各自保存参考帧，互不干扰
+    enum ChangeSource
+    {
+        CHANGE_IMG,
+        CHANGE_COLOR,
+        CHANGE_DEPTH,
+        CHANGE_ALIGNED,
+        CHANGE_SOURCE_COUNT
+    };
+    ChangeDetector changeDetectors[CHANGE_SOURCE_COUNT];
+    int lastChangeSource;
+    bool changeDetectionEnabled;
+
+    // 帧历史环形缓冲
+    std::unique_ptr<FrameHistory> history;
+
+    // 去畸变器 (深度使用最近邻插值)
+    Undistorter colorUndistorter;
+    Undistorter depthUndistorter;
+    Undistorter irUndistorter;
+
     /**
      * @brief 获取最新帧集
      *
@@ -117,6 +299,15 @@ private:
      */
     bool updateFrameset(uint32_t timeout_ms = 1000);
 
+    /**
+     * @brief 获取按时间戳配对的彩色帧和深度帧
+     *
+     * @param colorFrame 输出的彩色帧
+     * @param depthFrame 输出的深度帧
+     * @return bool 是否成功获取
+     */
+    bool updatePairedFrames(std::shared_ptr<ob::ColorFrame> &colorFrame, std::shared_ptr<ob::DepthFrame> &depthFrame);
+
     /**
      * @brief 转换颜色帧格式为BGR
      *
@@ -124,6 +315,25 @@ private:
      * @return std::shared_ptr<ob::ColorFrame> BGR格式的颜色帧
      */
     std::shared_ptr<ob::ColorFrame> convertColorToBGR(std::shared_ptr<ob::ColorFrame> colorFrame);
+
+    /**
+     * @brief 生成输出图像 (拷贝或去畸变)
+     *
+     * @param frameMat 引用SDK帧内存的图像
+     * @param undistort 是否去畸变
+     * @param undistorter 对应流的去畸变器
+     * @return cv::Mat 输出图像
+     */
+    cv::Mat outputImage(const cv::Mat &frameMat, bool undistort, Undistorter &undistorter);
+
+    /**
+     * @brief 用新取得的图像更新对应接口的变化掩码 (未开启变化检测时忽略)
+     *
+     * @param source 取图接口
+     * @param colorImg 彩色图像，可为空
+     * @param depthImg 深度图像，可为空
+     */
+    void updateChangeMask(ChangeSource source, const cv::Mat &colorImg, const cv::Mat &depthImg);
 };
 
 #endif // ORBBEC_DABAI_HPP
\ No newline at end of file
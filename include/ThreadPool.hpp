@@ -0,0 +1,94 @@
+/**
+ * @file ThreadPool.hpp
+ * @author Guo1ZY 132872017@qq.com
+ * @brief 工作窃取线程池
+ * @version 0.1
+ * @date 2025-01-15
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 工作窃取线程池
+ *
+ * 每个工作线程有自己的任务队列: 工作线程内提交的任务进入本线程队列尾部并优先
+ * 从尾部取出 (缓存友好)，空闲线程从其他队列头部窃取。外部线程提交的任务轮流分配。
+ */
+class ThreadPool
+{
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param threadCount 线程数，0表示使用硬件线程数
+     */
+    explicit ThreadPool(size_t threadCount = 0);
+
+    /**
+     * @brief 析构函数，执行完已提交的任务后退出
+     */
+    ~ThreadPool();
+
+    /**
+     * @brief 提交任务
+     *
+     * @param task 任务
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief 获取线程数
+     *
+     * @return size_t 线程数
+     */
+    size_t size() const;
+
+private:
+    /**
+     * @brief 单个工作线程的任务队列
+     */
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> threads;
+
+    // 待执行任务数与休眠唤醒
+    std::atomic<size_t> pending;
+    std::atomic<size_t> nextQueue;
+    bool stopping;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+
+    /**
+     * @brief 从本线程队列尾部取任务
+     */
+    bool popLocal(size_t index, std::function<void()> &task);
+
+    /**
+     * @brief 从其他线程队列头部窃取任务
+     */
+    bool steal(size_t index, std::function<void()> &task);
+
+    /**
+     * @brief 工作线程主循环
+     */
+    void workerLoop(size_t index);
+};
+
+#endif // THREAD_POOL_HPP
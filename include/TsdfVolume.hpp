@@ -0,0 +1,194 @@
+/**
+ * @file TsdfVolume.hpp
+ * @author Guo1ZY 132872017@qq.com
+ * @brief 基于体素哈希的增量TSDF融合
+ * @version 0.1
+ * @date 2025-01-15
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef TSDF_VOLUME_HPP
+#define TSDF_VOLUME_HPP
+
+#include "ChangeDetector.hpp"
+#include <libobsensor/ObSensor.hpp>
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief TSDF融合参数
+ */
+struct TsdfParams
+{
+    float voxelSize;   // 体素边长(米)
+    float truncation;  // 截断距离(米)
+    float minDepth;    // 参与融合的最小深度(米)
+    float maxDepth;    // 参与融合的最大深度(米)
+    int maxWeight;     // 体素权重上限
+    size_t maxBlocks;  // 体素块预算，决定内存上限
+    int pixelStride;   // 分配体素块时的像素采样步长
+
+    TsdfParams()
+        : voxelSize(0.01f), truncation(0.04f), minDepth(0.2f), maxDepth(3.0f),
+          maxWeight(64), maxBlocks(16384), pixelStride(2)
+    {
+    }
+};
+
+/**
+ * @brief 增量TSDF体积
+ *
+ * 使用稀疏体素哈希管理固定大小 (8x8x8) 的体素块，体素块从预分配的块池中取出，
+ * 内存上限由块预算决定。每帧只融合深度观测附近的可见块，并行处理。
+ * 按需提供光线投射和网格导出 (Surface Nets, PLY格式)。
+ * 开启变化检测后，相机位姿与上一次融合相同时跳过图像中未变化的块，
+ * 参考帧与位姿由体积自己保存，reset后全部重新融合。
+ */
+class TsdfVolume
+{
+public:
+    static const int BLOCK_SIZE = 8;
+    static const int BLOCK_VOXELS = BLOCK_SIZE * BLOCK_SIZE * BLOCK_SIZE;
+
+    /**
+     * @brief 体素 (8字节)
+     */
+    struct Voxel
+    {
+        int16_t tsdf;     // 截断符号距离，归一化到[-32767, 32767]
+        uint16_t weight;  // 融合权重，0表示未观测
+        uint8_t color[3]; // BGR颜色
+        uint8_t reserved;
+    };
+
+    /**
+     * @brief 构造函数，按块预算预分配块池
+     *
+     * @param params 融合参数
+     */
+    explicit TsdfVolume(const TsdfParams &params = TsdfParams());
+
+    /**
+     * @brief 清空体积及变化检测参考帧
+     */
+    void reset();
+
+    /**
+     * @brief 开启或关闭分块变化检测，并清空参考帧
+     *
+     * @param enable 是否开启
+     * @param tileSize 块边长(像素)，建议16或32
+     */
+    void setChangeDetection(bool enable, int tileSize = 32);
+
+    /**
+     * @brief 设置变化检测滞回阈值 (块内每像素平均绝对差)
+     *
+     * @param depthHigh 深度高阈值(深度单位，通常为毫米)
+     * @param depthLow 深度低阈值
+     * @param colorHigh 彩色高阈值(灰度级)
+     * @param colorLow 彩色低阈值
+     */
+    void setChangeThresholds(float depthHigh, float depthLow, float colorHigh, float colorLow);
+
+    /**
+     * @brief 融合一帧深度 (和可选的彩色) 图像
+     *
+     * @param depthImg 深度图像 (CV_16UC1)
+     * @param colorImg 与深度对齐的彩色图像 (CV_8UC3)，可为空
+     * @param intrinsic 深度图像对应的相机内参
+     * @param cameraPose 相机到世界坐标系的位姿
+     * @param depthScale 深度缩放因子(米/单位)
+     * @return bool 是否成功
+     */
+    bool integrate(const cv::Mat &depthImg, const cv::Mat &colorImg, const OBCameraIntrinsic &intrinsic,
+                   const cv::Matx44f &cameraPose, float depthScale = 0.001f);
+
+    /**
+     * @brief 光线投射生成指定视角的深度和彩色图像
+     *
+     * @param intrinsic 相机内参 (输出尺寸取内参宽高)
+     * @param cameraPose 相机到世界坐标系的位姿
+     * @param depthImg 输出深度图像 (CV_32FC1，米，0表示无表面)
+     * @param colorImg 输出彩色图像 (CV_8UC3)
+     */
+    void raycast(const OBCameraIntrinsic &intrinsic, const cv::Matx44f &cameraPose,
+                 cv::Mat &depthImg, cv::Mat &colorImg) const;
+
+    /**
+     * @brief 提取表面网格并保存为PLY文件
+     *
+     * @param filename 文件名
+     * @return bool 是否成功
+     */
+    bool exportMesh(const std::string &filename) const;
+
+    /**
+     * @brief 获取已分配的体素块数量
+     *
+     * @return size_t 体素块数量
+     */
+    size_t getBlockCount() const;
+
+    /**
+     * @brief 获取因块预算不足而未分配的体素块数量 (累计)
+     *
+     * @return size_t 体素块数量
+     */
+    size_t getDroppedBlockCount() const;
+
+private:
+    TsdfParams params;
+
+    // 块池 (maxBlocks * BLOCK_VOXELS 个体素) 与已用块数量
+    std::vector<Voxel> voxelPool;
+    size_t usedBlocks;
+    size_t droppedBlocks;
+
+    // 块坐标 -> 块池下标
+    std::unordered_map<uint64_t, int> blockMap;
+
+    // 每块最近一次可见的帧号，用于本帧可见块去重
+    std::vector<uint32_t> blockLastVisible;
+    std::vector<uint64_t> blockKeys;
+    uint32_t frameIndex;
+
+    // 本帧可见块列表 (复用)
+    std::vector<int> visibleBlocks;
+
+    // 分配阶段每个行带的候选块及合并结果 (复用)
+    std::vector<std::vector<uint64_t>> candidateKeys;
+    std::vector<uint64_t> mergedKeys;
+
+    // 变化检测: 参考帧为本体积上一次融合的帧，位姿变化时整帧融合
+    ChangeDetector changes;
+    bool changeDetectionEnabled;
+    bool hasLastPose;
+    cv::Matx44f lastPose;
+
+    /**
+     * @brief 块坐标打包为哈希键
+     */
+    static uint64_t packKey(int x, int y, int z);
+
+    /**
+     * @brief 哈希键解包为块坐标
+     */
+    static void unpackKey(uint64_t key, int &x, int &y, int &z);
+
+    /**
+     * @brief 按哈希键查找或分配体素块，预算耗尽时返回-1
+     */
+    int allocateBlock(uint64_t key);
+
+    /**
+     * @brief 按全局体素坐标查找体素，未分配时返回nullptr
+     */
+    const Voxel *findVoxel(int x, int y, int z) const;
+};
+
+#endif // TSDF_VOLUME_HPP
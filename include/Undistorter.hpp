@@ -0,0 +1,101 @@
+/**
+ * @file Undistorter.hpp
+ * @author Guo1ZY 132872017@qq.com
+ * @brief 预计算定点去畸变映射
+ * @version 0.1
+ * @date 2025-01-15
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef UNDISTORTER_HPP
+#define UNDISTORTER_HPP
+
+#include "ImageUtils.hpp"
+#include <libobsensor/ObSensor.hpp>
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief 图像去畸变器
+ *
+ * 根据SDK内参和畸变系数一次性生成定点格式映射表 (CV_16SC2 + 插值表)，
+ * 之后每帧按行分块并行remap到池化缓冲区。最近邻模式使用四舍五入的
+ * 整数映射，深度值不会在边缘处被插值混合。
+ */
+class Undistorter
+{
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param interpolation 插值方式 (cv::INTER_LINEAR 或 cv::INTER_NEAREST)
+     */
+    explicit Undistorter(int interpolation = cv::INTER_LINEAR);
+
+    /**
+     * @brief 设置相机内参和畸变系数，映射表在下一次使用时按图像尺寸生成
+     *
+     * @param intrinsic 相机内参
+     * @param distortion 畸变系数
+     */
+    void setParams(const OBCameraIntrinsic &intrinsic, const OBCameraDistortion &distortion);
+
+    /**
+     * @brief 是否已设置相机参数
+     *
+     * @return bool 是否已设置
+     */
+    bool isConfigured() const;
+
+    /**
+     * @brief 设置输出缓冲池容量，应不小于同时被外部持有的输出图像数量
+     *
+     * @param size 缓冲池容量
+     */
+    void setPoolSize(size_t size);
+
+    /**
+     * @brief 图像去畸变
+     *
+     * @param src 输入图像 (可直接引用SDK帧内存)
+     * @return cv::Mat 去畸变图像，内存来自缓冲池，调用方释放后复用
+     */
+    cv::Mat undistort(const cv::Mat &src);
+
+    /**
+     * @brief 查询去畸变图像中像素对应的原始图像像素
+     *
+     * @param imageSize 图像尺寸
+     * @param x 去畸变图像x坐标
+     * @param y 去畸变图像y坐标
+     * @param srcX 输出原始图像x坐标
+     * @param srcY 输出原始图像y坐标
+     * @return bool 对应像素是否在原始图像内
+     */
+    bool mapPoint(const cv::Size &imageSize, int x, int y, int &srcX, int &srcY);
+
+private:
+    int interpolation;
+    bool configured;
+
+    // 相机参数
+    OBCameraIntrinsic intrinsic;
+    OBCameraDistortion distortion;
+
+    // 定点映射表 (map1: CV_16SC2 整数坐标, map2: CV_16UC1 插值表索引)
+    cv::Size mapSize;
+    cv::Mat map1;
+    cv::Mat map2;
+
+    // 输出缓冲池
+    BufferPool bufferPool;
+
+    /**
+     * @brief 按图像尺寸生成映射表 (尺寸不变时直接复用)
+     *
+     * @param imageSize 图像尺寸
+     */
+    void ensureMaps(const cv::Size &imageSize);
+};
+
+#endif // UNDISTORTER_HPP
@@ -0,0 +1,119 @@
+/**
+ * @file VirtualScan.hpp
+ * @author Guo1ZY 132872017@qq.com
+ * @brief 深度图转虚拟二维激光扫描
+ * @version 0.1
+ * @date 2025-01-15
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#ifndef VIRTUAL_SCAN_HPP
+#define VIRTUAL_SCAN_HPP
+
+#include <libobsensor/ObSensor.hpp>
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief 虚拟扫描参数
+ */
+struct VirtualScanParams
+{
+    float minHeight; // 高度带下限(米，相对光轴，向上为正)
+    float maxHeight; // 高度带上限(米)
+    float rangeMin;  // 最小有效距离(米)
+    float rangeMax;  // 最大有效距离(米)
+
+    VirtualScanParams()
+        : minHeight(-0.05f), maxHeight(0.05f), rangeMin(0.2f), rangeMax(5.0f)
+    {
+    }
+};
+
+/**
+ * @brief 二维激光扫描数据
+ *
+ * 角度按从右到左递增排列 (与ROS LaserScan一致)，针孔模型下角度间隔不均匀，
+ * 因此显式给出每个点的角度。无效点距离为+inf。
+ */
+struct LaserScan
+{
+    std::vector<float> angles; // 角度(弧度)，0为光轴方向，向左为正
+    std::vector<float> ranges; // 水平面内距离(米)
+    float rangeMin;
+    float rangeMax;
+};
+
+/**
+ * @brief 深度图转虚拟激光扫描
+ *
+ * 不生成点云: 像素高度只取决于行号和深度，因此高度带预计算为每行的深度上下限，
+ * 每列角度、距离系数和距离范围对应的深度上下限也预先计算；每帧只做一次SIMD逐列取最小值。
+ * 假设相机水平安装 (光轴与地面平行)。
+ */
+class VirtualScan
+{
+public:
+    /**
+     * @brief 构造函数
+     *
+     * @param params 扫描参数
+     */
+    explicit VirtualScan(const VirtualScanParams &params = VirtualScanParams());
+
+    /**
+     * @brief 设置扫描参数，查找表在下一帧重建
+     *
+     * @param params 扫描参数
+     */
+    void setParams(const VirtualScanParams &params);
+
+    /**
+     * @brief 设置深度图像对应的相机内参，内参变化时查找表在下一帧重建
+     *
+     * @param intrinsic 相机内参
+     */
+    void setIntrinsic(const OBCameraIntrinsic &intrinsic);
+
+    /**
+     * @brief 深度图转换为激光扫描
+     *
+     * @param depthImg 深度图像 (CV_16UC1)
+     * @param scan 输出扫描数据，数组容量在多帧之间复用
+     * @param depthScale 深度缩放因子(米/单位)
+     * @return bool 是否成功
+     */
+    bool convert(const cv::Mat &depthImg, LaserScan &scan, float depthScale = 0.001f);
+
+private:
+    VirtualScanParams params;
+    OBCameraIntrinsic intrinsic;
+
+    // 查找表对应的图像尺寸与深度缩放
+    cv::Size tableSize;
+    float tableScale;
+
+    // 每行高度带对应的深度范围 (原始深度单位)，rowMin > rowMax表示该行不参与
+    std::vector<uint16_t> rowMin;
+    std::vector<uint16_t> rowMax;
+
+    // 每列角度与 z深度 -> 水平距离 系数
+    std::vector<float> columnAngle;
+    std::vector<float> columnRangeFactor;
+
+    // 每列距离范围对应的原始深度上下限，columnLow > columnHigh表示该列不参与
+    std::vector<uint16_t> columnLow;
+    std::vector<uint16_t> columnHigh;
+
+    // 逐列最小深度 (复用)
+    std::vector<uint16_t> columnMin;
+
+    /**
+     * @brief 按图像尺寸和深度缩放重建查找表
+     */
+    void buildTables(const cv::Size &imageSize, float depthScale);
+};
+
+#endif // VIRTUAL_SCAN_HPP
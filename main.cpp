@@ -24,12 +24,15 @@ int main()
     camera.init();
     camera.setCamera();
 
+    // 开启帧历史缓冲 (384MB，1280x720下约4.5秒)，空格键保存事件前后的原始帧
+    camera.enableHistory(384 * 1024 * 1024);
+
     // 时间测量变量
     timeval tt1, tt2;
 
     std::cout << "\nCamera controls:" << std::endl;
     std::cout << "  ESC - Exit program" << std::endl;
-    std::cout << "  Space - Save current images" << std::endl;
+    std::cout << "  Space - Save frames around the event (2s before, 1s after)" << std::endl;
     std::cout << "  'd' - Show center depth value" << std::endl;
     std::cout << "  'i' - Show camera info" << std::endl;
     std::cout << "\nStarting camera loop...\n"
@@ -101,43 +104,12 @@ int main()
             std::cout << "ESC pressed, exiting..." << std::endl;
             break;
         }
-        else if (key == 32) // 空格键保存图像
+        else if (key == 32) // 空格键保存事件前后的图像
         {
-            std::cout << "Saving images..." << std::endl;
-            auto saveImages = camera.getImg();
-            if (saveImages.size() >= 3)
+            std::string prefix = "event_" + std::to_string(frameCount);
+            if (camera.trigger(2.0, 1.0, prefix))
             {
-                // 保存彩色图像
-                if (!saveImages[0].empty())
-                {
-                    std::string colorFile = "color_" + std::to_string(frameCount) + ".jpg";
-                    cv::imwrite(colorFile, saveImages[0]);
-                    std::cout << "  Color image saved as: " << colorFile << std::endl;
-                }
-
-                // 保存深度图像
-                if (!saveImages[1].empty())
-                {
-                    std::string depthFile = "depth_" + std::to_string(frameCount) + ".png";
-                    cv::imwrite(depthFile, saveImages[1]);
-                    std::cout << "  Depth image saved as: " << depthFile << std::endl;
-
-                    // 同时保存深度可视化图像
-                    cv::Mat depthVis;
-                    saveImages[1].convertTo(depthVis, CV_8UC1, 255.0 / 5000.0);
-                    cv::applyColorMap(depthVis, depthVis, cv::COLORMAP_JET);
-                    std::string depthVisFile = "depth_vis_" + std::to_string(frameCount) + ".jpg";
-                    cv::imwrite(depthVisFile, depthVis);
-                    std::cout << "  Depth visualization saved as: " << depthVisFile << std::endl;
-                }
-
-                // 保存红外图像
-                if (!saveImages[2].empty())
-                {
-                    std::string irFile = "ir_" + std::to_string(frameCount) + ".png";
-                    cv::imwrite(irFile, saveImages[2]);
-                    std::cout << "  IR image saved as: " << irFile << std::endl;
-                }
+                std::cout << "Event triggered, saving frames as: " << prefix << "_*" << std::endl;
             }
         }
         else if (key == 'd' || key == 'D') // 'd'键获取中心点深度
@@ -206,6 +178,13 @@ int main()
                 cv::imshow("Aligned Depth", alignedDepthVis);
 
                 std::cout << "Aligned images displayed in separate windows" << std::endl;
+
+                // 输出彩色/深度帧时间差统计
+                FrameSkewStats skew = camera.getFrameSkewStats();
+                std::cout << "Color/depth skew: last " << skew.lastSkewUs << "us, mean " << skew.meanSkewUs
+                          << "us, stddev " << skew.stddevSkewUs << "us, range [" << skew.minSkewUs << ", "
+                          << skew.maxSkewUs << "]us, pairs " << skew.pairCount
+                          << ", dropped color/depth " << skew.droppedColorCount << "/" << skew.droppedDepthCount << std::endl;
             }
             else
             {
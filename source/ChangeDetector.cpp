@@ -0,0 +1,298 @@
+/**
+ * @file ChangeDetector.cpp
+ * @author Guo1ZY 132872017@qq.com
+ * @brief 分块变化检测实现
+ * @version 0.1
+ * @date 2025-01-15
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "ChangeDetector.hpp"
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+    /**
+     * @brief 一行8位数据的绝对差之和
+     */
+    inline uint64_t rowSad(const uchar *a, const uchar *b, int n)
+    {
+        uint64_t sum = 0;
+        int i = 0;
+#if CV_SIMD
+        const int lanes = cv::v_uint8::nlanes;
+        for (; i <= n - lanes; i += lanes)
+        {
+            sum += cv::v_reduce_sad(cv::vx_load(a + i), cv::vx_load(b + i));
+        }
+#endif
+        for (; i < n; i++)
+        {
+            sum += std::abs(a[i] - b[i]);
+        }
+        return sum;
+    }
+
+    /**
+     * @brief 一行16位数据的绝对差之和
+     */
+    inline uint64_t rowSad(const ushort *a, const ushort *b, int n)
+    {
+        uint64_t sum = 0;
+        int i = 0;
+#if CV_SIMD
+        const int lanes = cv::v_uint16::nlanes;
+        for (; i <= n - lanes; i += lanes)
+        {
+            sum += cv::v_reduce_sad(cv::vx_load(a + i), cv::vx_load(b + i));
+        }
+#endif
+        for (; i < n; i++)
+        {
+            sum += std::abs(a[i] - b[i]);
+        }
+        return sum;
+    }
+}
+
+/**
+ * @brief 构造函数
+ */
+ChangeDetector::ChangeDetector(int tileSize)
+    : tileSize(std::max(8, tileSize)), depthHigh(15.0f), depthLow(8.0f), colorHigh(12.0f), colorLow(6.0f),
+      changedCount(0)
+{
+}
+
+/**
+ * @brief 设置滞回阈值
+ */
+void ChangeDetector::setThresholds(float depthHigh, float depthLow, float colorHigh, float colorLow)
+{
+    this->depthHigh = depthHigh;
+    this->depthLow = std::min(depthLow, depthHigh);
+    this->colorHigh = colorHigh;
+    this->colorLow = std::min(colorLow, colorHigh);
+}
+
+/**
+ * @brief 逐块计算平均绝对差
+ */
+void ChangeDetector::computeTileDiff(const cv::Mat &current, const cv::Mat &previous, const cv::Size &referenceSize,
+                                     cv::Mat &tileDiff) const
+{
+    const cv::Size grid = mask.size();
+    tileDiff.create(grid, CV_32FC1);
+
+    const int width = current.cols;
+    const int height = current.rows;
+    const int channels = current.channels();
+    const bool is16U = current.depth() == CV_16U;
+    const int tile = tileSize;
+
+    // 按块行并行，每个块行独立累加
+    cv::parallel_for_(cv::Range(0, grid.height), [&](const cv::Range &range)
+    {
+        std::vector<uint64_t> sums(grid.width);
+        std::vector<int> columnBegin(grid.width + 1);
+        for (int tx = 0; tx <= grid.width; tx++)
+        {
+            int x = std::min(referenceSize.width, tx * tile);
+            columnBegin[tx] = (int)((int64_t)x * width / referenceSize.width);
+        }
+
+        for (int ty = range.start; ty < range.end; ty++)
+        {
+            int y0 = (int)((int64_t)std::min(referenceSize.height, ty * tile) * height / referenceSize.height);
+            int y1 = (int)((int64_t)std::min(referenceSize.height, (ty + 1) * tile) * height / referenceSize.height);
+            std::fill(sums.begin(), sums.end(), 0);
+
+            for (int y = y0; y < y1; y++)
+            {
+                for (int tx = 0; tx < grid.width; tx++)
+                {
+                    int x0 = columnBegin[tx] * channels;
+                    int count = (columnBegin[tx + 1] - columnBegin[tx]) * channels;
+                    if (is16U)
+                    {
+                        sums[tx] += rowSad(current.ptr<ushort>(y) + x0, previous.ptr<ushort>(y) + x0, count);
+                    }
+                    else
+                    {
+                        sums[tx] += rowSad(current.ptr<uchar>(y) + x0, previous.ptr<uchar>(y) + x0, count);
+                    }
+                }
+            }
+
+            float *diffRow = tileDiff.ptr<float>(ty);
+            for (int tx = 0; tx < grid.width; tx++)
+            {
+                int64_t pixels = (int64_t)(y1 - y0) * (columnBegin[tx + 1] - columnBegin[tx]) * channels;
+                diffRow[tx] = pixels > 0 ? (float)((double)sums[tx] / pixels) : 0.0f;
+            }
+        }
+    });
+}
+
+/**
+ * @brief 将变化块的当前像素写入参考帧
+ */
+void ChangeDetector::updateReference(const cv::Mat &current, cv::Mat &previous, bool valid, const cv::Size &referenceSize) const
+{
+    if (!valid)
+    {
+        // 无可比较的参考帧时整帧保存
+        current.copyTo(previous);
+        return;
+    }
+
+    const cv::Size grid = mask.size();
+    const int width = current.cols;
+    const int height = current.rows;
+    const int tile = tileSize;
+
+    cv::parallel_for_(cv::Range(0, grid.height), [&](const cv::Range &range)
+    {
+        for (int ty = range.start; ty < range.end; ty++)
+        {
+            int y0 = (int)((int64_t)std::min(referenceSize.height, ty * tile) * height / referenceSize.height);
+            int y1 = (int)((int64_t)std::min(referenceSize.height, (ty + 1) * tile) * height / referenceSize.height);
+            const uchar *maskRow = mask.ptr<uchar>(ty);
+            for (int tx = 0; tx < grid.width; tx++)
+            {
+                if (!maskRow[tx])
+                {
+                    continue;
+                }
+                int x0 = (int)((int64_t)std::min(referenceSize.width, tx * tile) * width / referenceSize.width);
+                int x1 = (int)((int64_t)std::min(referenceSize.width, (tx + 1) * tile) * width / referenceSize.width);
+                if (x1 > x0 && y1 > y0)
+                {
+                    cv::Rect region(x0, y0, x1 - x0, y1 - y0);
+                    current(region).copyTo(previous(region));
+                }
+            }
+        }
+    });
+}
+
+/**
+ * @brief 输入新一帧并更新变化掩码
+ */
+const cv::Mat &ChangeDetector::update(const cv::Mat &colorImg, const cv::Mat &depthImg)
+{
+    const bool hasDepth = !depthImg.empty() && depthImg.type() == CV_16UC1;
+    const bool hasColor = !colorImg.empty() && colorImg.type() == CV_8UC3;
+    if (!hasDepth && !hasColor)
+    {
+        return mask;
+    }
+
+    // 块网格按深度图像划分，无深度时按彩色图像划分
+    const cv::Size referenceSize = hasDepth ? depthImg.size() : colorImg.size();
+    const cv::Size grid((referenceSize.width + tileSize - 1) / tileSize, (referenceSize.height + tileSize - 1) / tileSize);
+    if (mask.size() != grid)
+    {
+        // 分辨率变化，历史帧失效
+        mask.create(grid, CV_8UC1);
+        mask.setTo(255);
+        previousColor.release();
+        previousDepth.release();
+    }
+
+    const bool depthValid = hasDepth && previousDepth.size() == depthImg.size();
+    const bool colorValid = hasColor && previousColor.size() == colorImg.size();
+    if (depthValid)
+    {
+        computeTileDiff(depthImg, previousDepth, referenceSize, depthDiff);
+    }
+    if (colorValid)
+    {
+        computeTileDiff(colorImg, previousColor, referenceSize, colorDiff);
+    }
+
+    // 滞回: 已变化的块使用低阈值，未变化的块使用高阈值
+    changedCount = 0;
+    for (int ty = 0; ty < grid.height; ty++)
+    {
+        uchar *maskRow = mask.ptr<uchar>(ty);
+        const float *depthRow = depthValid ? depthDiff.ptr<float>(ty) : nullptr;
+        const float *colorRow = colorValid ? colorDiff.ptr<float>(ty) : nullptr;
+        for (int tx = 0; tx < grid.width; tx++)
+        {
+            bool wasChanged = maskRow[tx] != 0;
+            bool changed = false;
+            if (hasDepth)
+            {
+                changed = changed || !depthValid || depthRow[tx] > (wasChanged ? depthLow : depthHigh);
+            }
+            if (hasColor)
+            {
+                changed = changed || !colorValid || colorRow[tx] > (wasChanged ? colorLow : colorHigh);
+            }
+            maskRow[tx] = changed ? 255 : 0;
+            changedCount += changed;
+        }
+    }
+
+    // 只刷新变化块的参考像素，未变化块保留上次报告变化时的内容，缓慢漂移累积超过阈值后仍能检出;
+    // 拷贝到自有缓冲以免占用调用方的池化内存
+    if (hasDepth)
+    {
+        updateReference(depthImg, previousDepth, depthValid, referenceSize);
+    }
+    if (hasColor)
+    {
+        updateReference(colorImg, previousColor, colorValid, referenceSize);
+    }
+
+    return mask;
+}
+
+/**
+ * @brief 获取最近一次的变化掩码
+ */
+const cv::Mat &ChangeDetector::getMask() const
+{
+    return mask;
+}
+
+/**
+ * @brief 设置块边长
+ */
+void ChangeDetector::setTileSize(int tileSize)
+{
+    this->tileSize = std::max(8, tileSize);
+    reset();
+}
+
+/**
+ * @brief 获取块边长
+ */
+int ChangeDetector::getTileSize() const
+{
+    return tileSize;
+}
+
+/**
+ * @brief 获取变化块占比
+ */
+float ChangeDetector::getChangedRatio() const
+{
+    return mask.empty() ? 1.0f : (float)changedCount / (float)mask.total();
+}
+
+/**
+ * @brief 清空历史帧
+ */
+void ChangeDetector::reset()
+{
+    previousColor.release();
+    previousDepth.release();
+    mask.release();
+    changedCount = 0;
+}
@@ -0,0 +1,331 @@
+/**
+ * @file DepthCodec.cpp
+ * @author Guo1ZY 132872017@qq.com
+ * @brief 深度图无损编解码 (RVL) 实现
+ * @version 0.1
+ * @date 2025-01-15
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "DepthCodec.hpp"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    // 码流头: 魔数 + 宽 + 高
+    const uint8_t kMagic[4] = {'R', 'V', 'L', '1'};
+    const size_t kHeaderSize = 12;
+
+    /**
+     * @brief 4bit变长整数写入器
+     *
+     * 每个nibble低3位为数据、最高位为续位；nibble按写入顺序从高到低
+     * 填充32位字。使用64位累加器一次写入整个变长码，减少逐nibble分支。
+     */
+    struct NibbleWriter
+    {
+        uint8_t *ptr;
+        uint64_t acc;
+        int bits;
+
+        explicit NibbleWriter(uint8_t *dst) : ptr(dst), acc(0), bits(0) {}
+
+        inline void putCode(uint64_t code, int count)
+        {
+            acc = (acc << (4 * count)) | code;
+            bits += 4 * count;
+            if (bits >= 32)
+            {
+                bits -= 32;
+                uint32_t word = (uint32_t)(acc >> bits);
+                std::memcpy(ptr, &word, 4);
+                ptr += 4;
+            }
+        }
+
+        inline void putVLE(uint32_t value)
+        {
+            uint64_t code = 0;
+            int count = 0;
+            do
+            {
+                uint32_t nibble = value & 0x7;
+                value >>= 3;
+                if (value)
+                {
+                    nibble |= 0x8;
+                }
+                code = (code << 4) | nibble;
+                count++;
+                // 累加器剩余位数不足时先写出一部分
+                if (count == 7)
+                {
+                    putCode(code, count);
+                    code = 0;
+                    count = 0;
+                }
+            } while (value);
+            if (count)
+            {
+                putCode(code, count);
+            }
+        }
+
+        inline void flush()
+        {
+            if (bits)
+            {
+                uint32_t word = (uint32_t)(acc << (32 - bits));
+                std::memcpy(ptr, &word, 4);
+                ptr += 4;
+                acc = 0;
+                bits = 0;
+            }
+        }
+    };
+
+    /**
+     * @brief 4bit变长整数读取器
+     */
+    struct NibbleReader
+    {
+        const uint8_t *ptr;
+        const uint8_t *end;
+        uint64_t acc;
+        int bits;
+        bool overrun;
+
+        NibbleReader(const uint8_t *src, const uint8_t *srcEnd)
+            : ptr(src), end(srcEnd), acc(0), bits(0), overrun(false) {}
+
+        inline void refill()
+        {
+            if (end - ptr >= 4)
+            {
+                uint32_t word;
+                std::memcpy(&word, ptr, 4);
+                ptr += 4;
+                acc = (acc << 32) | word;
+                bits += 32;
+            }
+        }
+
+        inline uint32_t getVLE()
+        {
+            uint32_t value = 0;
+            int shift = 0;
+            uint32_t nibble;
+            do
+            {
+                if (bits < 4)
+                {
+                    refill();
+                    if (bits < 4)
+                    {
+                        overrun = true;
+                        return 0;
+                    }
+                }
+                bits -= 4;
+                nibble = (uint32_t)(acc >> bits) & 0xF;
+                value |= (nibble & 0x7) << shift;
+                shift += 3;
+            } while ((nibble & 0x8) && shift < 32);
+            return value;
+        }
+    };
+}
+
+/**
+ * @brief 构造函数
+ */
+DepthCodec::DepthCodec()
+{
+}
+
+/**
+ * @brief 编码深度图
+ */
+bool DepthCodec::encode(const cv::Mat &depthImg, std::vector<uint8_t> &output)
+{
+    if (depthImg.empty() || depthImg.type() != CV_16UC1)
+    {
+        std::cerr << "DepthCodec: input must be a non-empty CV_16UC1 image" << std::endl;
+        return false;
+    }
+
+    const uint32_t width = depthImg.cols;
+    const uint32_t height = depthImg.rows;
+    const size_t pixelCount = (size_t)width * height;
+
+    // 最坏情况下每个像素占6个nibble (3字节)，另加游程与对齐余量
+    output.resize(kHeaderSize + pixelCount * 3 + 64);
+    uint8_t *dst = output.data();
+    std::memcpy(dst, kMagic, 4);
+    std::memcpy(dst + 4, &width, 4);
+    std::memcpy(dst + 8, &height, 4);
+
+    // RVL要求按连续像素序列扫描，非连续输入 (如ROI) 先拷贝到复用缓冲
+    const cv::Mat *src = &depthImg;
+    if (!depthImg.isContinuous())
+    {
+        depthImg.copyTo(continuousBuffer);
+        src = &continuousBuffer;
+    }
+    const uint16_t *pixels = src->ptr<uint16_t>();
+    const uint16_t *pixelsEnd = pixels + pixelCount;
+
+    NibbleWriter writer(dst + kHeaderSize);
+    int previous = 0;
+
+    while (pixels != pixelsEnd)
+    {
+        // 零值游程
+        const uint16_t *zeroStart = pixels;
+        while (pixels != pixelsEnd && *pixels == 0)
+        {
+            pixels++;
+        }
+        writer.putVLE((uint32_t)(pixels - zeroStart));
+
+        // 有效像素游程
+        const uint16_t *runEnd = pixels;
+        while (runEnd != pixelsEnd && *runEnd != 0)
+        {
+            runEnd++;
+        }
+        writer.putVLE((uint32_t)(runEnd - pixels));
+
+        // 相邻有效像素差分，zigzag映射为无符号数
+        for (; pixels != runEnd; pixels++)
+        {
+            int current = *pixels;
+            int delta = current - previous;
+            writer.putVLE(((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31));
+            previous = current;
+        }
+    }
+
+    writer.flush();
+    output.resize(writer.ptr - dst);
+    return true;
+}
+
+/**
+ * @brief 解码深度图
+ */
+bool DepthCodec::decode(const uint8_t *data, size_t size, cv::Mat &depthImg)
+{
+    if (!data || size < kHeaderSize || std::memcmp(data, kMagic, 4) != 0)
+    {
+        std::cerr << "DepthCodec: invalid stream header" << std::endl;
+        return false;
+    }
+
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::memcpy(&width, data + 4, 4);
+    std::memcpy(&height, data + 8, 4);
+    if (width == 0 || height == 0 || width > 65535 || height > 65535)
+    {
+        std::cerr << "DepthCodec: invalid image size " << width << "x" << height << std::endl;
+        return false;
+    }
+
+    depthImg.create(height, width, CV_16UC1);
+    uint16_t *pixels = depthImg.ptr<uint16_t>();
+    uint16_t *pixelsEnd = pixels + (size_t)width * height;
+
+    NibbleReader reader(data + kHeaderSize, data + size);
+    int previous = 0;
+
+    while (pixels != pixelsEnd)
+    {
+        uint32_t zeros = reader.getVLE();
+        if (zeros > (uint32_t)(pixelsEnd - pixels))
+        {
+            break;
+        }
+        std::memset(pixels, 0, zeros * sizeof(uint16_t));
+        pixels += zeros;
+
+        uint32_t nonzeros = reader.getVLE();
+        if (nonzeros > (uint32_t)(pixelsEnd - pixels))
+        {
+            break;
+        }
+        for (uint32_t i = 0; i < nonzeros; i++)
+        {
+            uint32_t zigzag = reader.getVLE();
+            int delta = (int)(zigzag >> 1) ^ -(int)(zigzag & 1);
+            previous += delta;
+            *pixels++ = (uint16_t)previous;
+        }
+
+        if (reader.overrun)
+        {
+            break;
+        }
+    }
+
+    if (pixels != pixelsEnd || reader.overrun)
+    {
+        std::cerr << "DepthCodec: corrupted or truncated stream" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 解码深度图
+ */
+bool DepthCodec::decode(const std::vector<uint8_t> &input, cv::Mat &depthImg)
+{
+    return decode(input.data(), input.size(), depthImg);
+}
+
+/**
+ * @brief 编码深度图并保存为文件
+ */
+bool DepthCodec::save(const std::string &filename, const cv::Mat &depthImg)
+{
+    if (!encode(depthImg, streamBuffer))
+    {
+        return false;
+    }
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file)
+    {
+        std::cerr << "DepthCodec: cannot open " << filename << " for writing" << std::endl;
+        return false;
+    }
+    file.write((const char *)streamBuffer.data(), streamBuffer.size());
+    return (bool)file;
+}
+
+/**
+ * @brief 从文件读取并解码深度图
+ */
+bool DepthCodec::load(const std::string &filename, cv::Mat &depthImg)
+{
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file)
+    {
+        std::cerr << "DepthCodec: cannot open " << filename << std::endl;
+        return false;
+    }
+
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    streamBuffer.resize((size_t)size);
+    if (!file.read((char *)streamBuffer.data(), size))
+    {
+        std::cerr << "DepthCodec: failed to read " << filename << std::endl;
+        return false;
+    }
+    return decode(streamBuffer, depthImg);
+}
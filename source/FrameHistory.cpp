@@ -0,0 +1,451 @@
+/**
+ * @file FrameHistory.cpp
+ * @author Guo1ZY 132872017@qq.com
+ * @brief 按内存预算的帧历史环形缓冲与事件触发保存实现
+ * @version 0.1
+ * @date 2025-01-15
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "FrameHistory.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+/**
+ * @brief 构造函数
+ */
+FrameHistory::FrameHistory(size_t budgetBytes, size_t colorCapacity, size_t depthCapacity, size_t irCapacity)
+    : head(0), sequence(0), droppedCount(0), eventActive(false), eventEndUs(0), stopping(false)
+{
+    // 按预算计算槽位数量，至少保留两个槽位
+    size_t slotBytes = colorCapacity + depthCapacity + irCapacity;
+    size_t slotCount = slotBytes > 0 ? budgetBytes / slotBytes : 0;
+    slotCount = std::max<size_t>(slotCount, 2);
+
+    slots.resize(slotCount);
+    for (size_t i = 0; i < slotCount; i++)
+    {
+        Slot &slot = slots[i];
+        slot.sequence = 0;
+        slot.timestampUs = 0;
+        slot.pinned = false;
+        slot.color.resize(colorCapacity);
+        slot.colorSize = 0;
+        slot.depth.resize(depthCapacity);
+        slot.depthWidth = 0;
+        slot.depthHeight = 0;
+        slot.ir.resize(irCapacity);
+        slot.irWidth = 0;
+        slot.irHeight = 0;
+    }
+
+    encodeParams.push_back(cv::IMWRITE_JPEG_QUALITY);
+    encodeParams.push_back(90);
+    encodeBuffer.reserve(colorCapacity);
+    eventJob.slots.reserve(slotCount);
+
+    writerThread = std::thread(&FrameHistory::writerLoop, this);
+}
+
+/**
+ * @brief 析构函数，写完未完成的事件后退出
+ */
+FrameHistory::~FrameHistory()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (eventActive)
+        {
+            jobs.push_back(eventJob);
+            eventActive = false;
+        }
+        stopping = true;
+    }
+    jobReady.notify_all();
+    if (writerThread.joinable())
+    {
+        writerThread.join();
+    }
+}
+
+/**
+ * @brief 将彩色帧压缩保存到槽位
+ */
+bool FrameHistory::storeColor(Slot &slot, std::shared_ptr<ob::ColorFrame> colorFrame)
+{
+    slot.colorSize = 0;
+    if (!colorFrame)
+    {
+        return false;
+    }
+
+    const uint8_t *data = (const uint8_t *)colorFrame->data();
+    size_t size = colorFrame->dataSize();
+    int width = colorFrame->width();
+    int height = colorFrame->height();
+
+    // MJPG本身就是JPEG，直接拷贝
+    if (colorFrame->format() == OB_FORMAT_MJPG)
+    {
+        if (size > slot.color.size())
+        {
+            return false;
+        }
+        std::memcpy(slot.color.data(), data, size);
+        slot.colorSize = size;
+        return true;
+    }
+
+    // 其他格式先转BGR再编码JPEG
+    cv::Mat bgr;
+    switch (colorFrame->format())
+    {
+    case OB_FORMAT_YUYV:
+        cv::cvtColor(cv::Mat(height, width, CV_8UC2, (void *)data), colorBuffer, cv::COLOR_YUV2BGR_YUYV);
+        bgr = colorBuffer;
+        break;
+    case OB_FORMAT_UYVY:
+        cv::cvtColor(cv::Mat(height, width, CV_8UC2, (void *)data), colorBuffer, cv::COLOR_YUV2BGR_UYVY);
+        bgr = colorBuffer;
+        break;
+    case OB_FORMAT_RGB:
+        cv::cvtColor(cv::Mat(height, width, CV_8UC3, (void *)data), colorBuffer, cv::COLOR_RGB2BGR);
+        bgr = colorBuffer;
+        break;
+    case OB_FORMAT_BGR:
+        bgr = cv::Mat(height, width, CV_8UC3, (void *)data);
+        break;
+    default:
+        return false;
+    }
+
+    if (!cv::imencode(".jpg", bgr, encodeBuffer, encodeParams) || encodeBuffer.size() > slot.color.size())
+    {
+        return false;
+    }
+    std::memcpy(slot.color.data(), encodeBuffer.data(), encodeBuffer.size());
+    slot.colorSize = encodeBuffer.size();
+    return true;
+}
+
+/**
+ * @brief 将原始帧数据拷贝到槽位
+ */
+bool FrameHistory::storeRaw(std::vector<uint8_t> &buffer, int &width, int &height, std::shared_ptr<ob::VideoFrame> frame)
+{
+    width = 0;
+    height = 0;
+    if (!frame)
+    {
+        return false;
+    }
+
+    size_t size = (size_t)frame->width() * frame->height() * sizeof(uint16_t);
+    if (size > buffer.size() || size > frame->dataSize())
+    {
+        return false;
+    }
+    std::memcpy(buffer.data(), frame->data(), size);
+    width = frame->width();
+    height = frame->height();
+    return true;
+}
+
+/**
+ * @brief 推入一帧帧集
+ */
+void FrameHistory::push(std::shared_ptr<ob::FrameSet> frameset)
+{
+    if (!frameset)
+    {
+        return;
+    }
+
+    auto colorFrame = frameset->colorFrame();
+    auto depthFrame = frameset->depthFrame();
+    auto irFrame = frameset->irFrame();
+
+    uint64_t timestampUs = 0;
+    if (depthFrame)
+    {
+        timestampUs = depthFrame->timeStampUs();
+    }
+    else if (colorFrame)
+    {
+        timestampUs = colorFrame->timeStampUs();
+    }
+    else if (irFrame)
+    {
+        timestampUs = irFrame->timeStampUs();
+    }
+    else
+    {
+        return;
+    }
+
+    // 取出下一个槽位，跳过被事件锁定的槽位
+    size_t index = slots.size();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t n = 0; n < slots.size(); n++)
+        {
+            size_t i = (head + n) % slots.size();
+            if (!slots[i].pinned)
+            {
+                index = i;
+                break;
+            }
+        }
+        if (index == slots.size())
+        {
+            droppedCount++;
+            // 缓冲已被事件占满，提前结束事件以便写盘释放槽位
+            if (eventActive)
+            {
+                jobs.push_back(eventJob);
+                eventJob.slots.clear();
+                eventActive = false;
+                jobReady.notify_one();
+            }
+            return;
+        }
+        head = (index + 1) % slots.size();
+        slots[index].sequence = 0;
+    }
+
+    // 拷贝在锁外进行，写盘线程只访问已锁定的槽位
+    Slot &slot = slots[index];
+    storeColor(slot, colorFrame);
+    storeRaw(slot.depth, slot.depthWidth, slot.depthHeight, depthFrame);
+    storeRaw(slot.ir, slot.irWidth, slot.irHeight, irFrame);
+
+    bool notify = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        slot.timestampUs = timestampUs;
+        slot.sequence = ++sequence;
+
+        // 事件进行中: 事件后的帧同样锁定
+        if (eventActive)
+        {
+            slot.pinned = true;
+            eventJob.slots.push_back(index);
+            if (timestampUs >= eventEndUs)
+            {
+                jobs.push_back(eventJob);
+                eventJob.slots.clear();
+                eventActive = false;
+                notify = true;
+            }
+        }
+    }
+    if (notify)
+    {
+        jobReady.notify_one();
+    }
+}
+
+/**
+ * @brief 触发事件保存
+ */
+bool FrameHistory::trigger(double preSeconds, double postSeconds, const std::string &prefix)
+{
+    bool notify = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (eventActive)
+        {
+            std::cerr << "FrameHistory: previous event still recording" << std::endl;
+            return false;
+        }
+
+        // 最新一帧的时间作为事件时刻; 按未锁定槽位的时间跨度估计帧间隔
+        uint64_t latestUs = 0;
+        uint64_t oldestUs = 0;
+        size_t filledCount = 0;
+        size_t freeCount = 0;
+        for (size_t i = 0; i < slots.size(); i++)
+        {
+            const Slot &slot = slots[i];
+            if (slot.sequence && slot.timestampUs > latestUs)
+            {
+                latestUs = slot.timestampUs;
+            }
+            if (slot.pinned)
+            {
+                continue;
+            }
+            freeCount++;
+            if (slot.sequence)
+            {
+                oldestUs = filledCount ? std::min(oldestUs, slot.timestampUs) : slot.timestampUs;
+                filledCount++;
+            }
+        }
+
+        // 事件后的帧需要空闲槽位，不足时拒绝触发
+        uint64_t postUs = (uint64_t)(std::max(0.0, postSeconds) * 1e6);
+        size_t postSlots = 0;
+        if (postUs > 0 && filledCount > 1 && latestUs > oldestUs)
+        {
+            uint64_t intervalUs = (latestUs - oldestUs) / (filledCount - 1);
+            postSlots = (size_t)((postUs + intervalUs - 1) / intervalUs) + 1;
+        }
+        if (postSlots >= freeCount)
+        {
+            std::cerr << "FrameHistory: " << postSeconds << "s post-event window needs " << postSlots
+                      << " slots, only " << freeCount << " free; trigger rejected" << std::endl;
+            return false;
+        }
+
+        uint64_t preUs = (uint64_t)(std::max(0.0, preSeconds) * 1e6);
+        uint64_t startUs = latestUs > preUs ? latestUs - preUs : 0;
+
+        // 收集事件前的帧并按时间顺序排列
+        eventJob.prefix = prefix;
+        eventJob.slots.clear();
+        for (size_t i = 0; i < slots.size(); i++)
+        {
+            const Slot &slot = slots[i];
+            if (slot.sequence && !slot.pinned && slot.timestampUs >= startUs)
+            {
+                eventJob.slots.push_back(i);
+            }
+        }
+        std::sort(eventJob.slots.begin(), eventJob.slots.end(), [this](size_t a, size_t b)
+                  { return slots[a].sequence < slots[b].sequence; });
+
+        // 为事件后的帧保留槽位，事件前的帧超出时只保留最近的部分
+        size_t maxPreSlots = freeCount - postSlots;
+        if (eventJob.slots.size() > maxPreSlots)
+        {
+            size_t excess = eventJob.slots.size() - maxPreSlots;
+            eventJob.slots.erase(eventJob.slots.begin(), eventJob.slots.begin() + excess);
+            std::cerr << "FrameHistory: buffer too small for " << preSeconds << "s + " << postSeconds
+                      << "s, pre-event window shortened to " << maxPreSlots << " frames" << std::endl;
+        }
+        for (size_t i = 0; i < eventJob.slots.size(); i++)
+        {
+            slots[eventJob.slots[i]].pinned = true;
+        }
+
+        eventEndUs = latestUs + postUs;
+        if (postSeconds > 0)
+        {
+            eventActive = true;
+        }
+        else
+        {
+            jobs.push_back(eventJob);
+            eventJob.slots.clear();
+            notify = true;
+        }
+    }
+    if (notify)
+    {
+        jobReady.notify_one();
+    }
+    return true;
+}
+
+/**
+ * @brief 后台写盘线程
+ */
+void FrameHistory::writerLoop()
+{
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobReady.wait(lock, [this]
+                          { return stopping || !jobs.empty(); });
+            if (jobs.empty())
+            {
+                return;
+            }
+            job = jobs.front();
+            jobs.pop_front();
+        }
+
+        for (size_t i = 0; i < job.slots.size(); i++)
+        {
+            size_t index = job.slots[i];
+            writeSlot(slots[index], job.prefix, i);
+
+            // 写完后槽位重新参与循环
+            std::lock_guard<std::mutex> lock(mutex);
+            slots[index].pinned = false;
+        }
+        std::cout << "Event saved: " << job.prefix << " (" << job.slots.size() << " frames)" << std::endl;
+    }
+}
+
+/**
+ * @brief 保存一个槽位到文件
+ */
+void FrameHistory::writeSlot(const Slot &slot, const std::string &prefix, size_t index)
+{
+    std::string name = prefix + "_" + std::to_string(index) + "_" + std::to_string(slot.timestampUs);
+
+    if (slot.colorSize)
+    {
+        std::ofstream file(name + "_color.jpg", std::ios::binary);
+        file.write((const char *)slot.color.data(), slot.colorSize);
+    }
+
+    if (slot.depthWidth && slot.depthHeight)
+    {
+        cv::Mat depthImg(slot.depthHeight, slot.depthWidth, CV_16UC1, (void *)slot.depth.data());
+        depthCodec.save(name + "_depth.rvl", depthImg);
+    }
+
+    if (slot.irWidth && slot.irHeight)
+    {
+        cv::Mat irImg(slot.irHeight, slot.irWidth, CV_16UC1, (void *)slot.ir.data());
+        cv::imwrite(name + "_ir.png", irImg);
+    }
+}
+
+/**
+ * @brief 获取槽位数量
+ */
+size_t FrameHistory::getSlotCount() const
+{
+    return slots.size();
+}
+
+/**
+ * @brief 获取当前缓冲覆盖的时长
+ */
+double FrameHistory::getBufferedSeconds() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t oldest = 0;
+    uint64_t latest = 0;
+    for (size_t i = 0; i < slots.size(); i++)
+    {
+        if (!slots[i].sequence)
+        {
+            continue;
+        }
+        if (!oldest || slots[i].timestampUs < oldest)
+        {
+            oldest = slots[i].timestampUs;
+        }
+        latest = std::max(latest, slots[i].timestampUs);
+    }
+    return (latest - oldest) / 1e6;
+}
+
+/**
+ * @brief 获取丢弃帧数
+ */
+uint64_t FrameHistory::getDroppedCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return droppedCount;
+}
@@ -0,0 +1,213 @@
+/**
+ * @file FramePairer.cpp
+ * @author Guo1ZY 132872017@qq.com
+ * @brief 基于时间戳的彩色/深度帧配对实现
+ * @version 0.1
+ * @date 2025-01-15
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "FramePairer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+/**
+ * @brief 构造函数
+ */
+FramePairer::FramePairer(size_t capacity, uint64_t toleranceUs)
+    : capacity(capacity > 0 ? capacity : 1), toleranceUs(toleranceUs)
+{
+    resetStats();
+}
+
+/**
+ * @brief 设置配对容差
+ */
+void FramePairer::setTolerance(uint64_t toleranceUs)
+{
+    this->toleranceUs = toleranceUs;
+}
+
+/**
+ * @brief 获取配对容差
+ */
+uint64_t FramePairer::getTolerance() const
+{
+    return toleranceUs;
+}
+
+/**
+ * @brief 将帧集中的彩色帧和深度帧加入缓存
+ */
+void FramePairer::push(std::shared_ptr<ob::FrameSet> frameset)
+{
+    if (!frameset)
+    {
+        return;
+    }
+
+    auto colorFrame = frameset->colorFrame();
+    if (colorFrame)
+    {
+        // 同一帧可能随多个帧集重复下发，按时间戳去重
+        if (colorQueue.empty() || colorQueue.back()->timeStampUs() != colorFrame->timeStampUs())
+        {
+            colorQueue.push_back(colorFrame);
+            if (colorQueue.size() > capacity)
+            {
+                colorQueue.pop_front();
+                stats.droppedColorCount++;
+            }
+        }
+    }
+
+    auto depthFrame = frameset->depthFrame();
+    if (depthFrame)
+    {
+        if (depthQueue.empty() || depthQueue.back()->timeStampUs() != depthFrame->timeStampUs())
+        {
+            depthQueue.push_back(depthFrame);
+            if (depthQueue.size() > capacity)
+            {
+                depthQueue.pop_front();
+                stats.droppedDepthCount++;
+            }
+        }
+    }
+}
+
+/**
+ * @brief 查找时间差最小的配对
+ */
+bool FramePairer::findClosest(size_t &colorIndex, size_t &depthIndex, int64_t &skewUs) const
+{
+    if (colorQueue.empty() || depthQueue.empty())
+    {
+        return false;
+    }
+
+    // 缓存很小，直接枚举全部组合
+    bool found = false;
+    uint64_t bestAbs = 0;
+    for (size_t i = 0; i < colorQueue.size(); i++)
+    {
+        int64_t colorTs = (int64_t)colorQueue[i]->timeStampUs();
+        for (size_t j = 0; j < depthQueue.size(); j++)
+        {
+            int64_t skew = colorTs - (int64_t)depthQueue[j]->timeStampUs();
+            uint64_t absSkew = (uint64_t)std::llabs(skew);
+            if (!found || absSkew < bestAbs)
+            {
+                found = true;
+                bestAbs = absSkew;
+                colorIndex = i;
+                depthIndex = j;
+                skewUs = skew;
+            }
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief 取出指定配对，并丢弃两个流中更早的帧
+ */
+void FramePairer::take(size_t colorIndex, size_t depthIndex, int64_t skewUs,
+                       std::shared_ptr<ob::ColorFrame> &colorFrame, std::shared_ptr<ob::DepthFrame> &depthFrame)
+{
+    colorFrame = colorQueue[colorIndex];
+    depthFrame = depthQueue[depthIndex];
+
+    // 比配对帧更早的帧不会再有更好的配对
+    stats.droppedColorCount += colorIndex;
+    stats.droppedDepthCount += depthIndex;
+    colorQueue.erase(colorQueue.begin(), colorQueue.begin() + colorIndex + 1);
+    depthQueue.erase(depthQueue.begin(), depthQueue.begin() + depthIndex + 1);
+
+    // 更新统计
+    stats.pairCount++;
+    if ((uint64_t)std::llabs(skewUs) > toleranceUs)
+    {
+        stats.outOfToleranceCount++;
+    }
+    stats.lastSkewUs = skewUs;
+    if (stats.pairCount == 1)
+    {
+        stats.minSkewUs = skewUs;
+        stats.maxSkewUs = skewUs;
+    }
+    else
+    {
+        stats.minSkewUs = std::min(stats.minSkewUs, skewUs);
+        stats.maxSkewUs = std::max(stats.maxSkewUs, skewUs);
+    }
+
+    double n = (double)stats.pairCount;
+    double delta = (double)skewUs - stats.meanSkewUs;
+    stats.meanSkewUs += delta / n;
+    skewM2 += delta * ((double)skewUs - stats.meanSkewUs);
+    stats.stddevSkewUs = stats.pairCount > 1 ? std::sqrt(skewM2 / (n - 1.0)) : 0.0;
+    stats.meanAbsSkewUs += ((double)std::llabs(skewUs) - stats.meanAbsSkewUs) / n;
+}
+
+/**
+ * @brief 取出容差内时间差最小的配对
+ */
+bool FramePairer::pop(std::shared_ptr<ob::ColorFrame> &colorFrame, std::shared_ptr<ob::DepthFrame> &depthFrame)
+{
+    size_t colorIndex = 0;
+    size_t depthIndex = 0;
+    int64_t skewUs = 0;
+    if (!findClosest(colorIndex, depthIndex, skewUs) || (uint64_t)std::llabs(skewUs) > toleranceUs)
+    {
+        return false;
+    }
+
+    take(colorIndex, depthIndex, skewUs, colorFrame, depthFrame);
+    return true;
+}
+
+/**
+ * @brief 取出当前缓存中时间差最小的配对
+ */
+bool FramePairer::popBest(std::shared_ptr<ob::ColorFrame> &colorFrame, std::shared_ptr<ob::DepthFrame> &depthFrame)
+{
+    size_t colorIndex = 0;
+    size_t depthIndex = 0;
+    int64_t skewUs = 0;
+    if (!findClosest(colorIndex, depthIndex, skewUs))
+    {
+        return false;
+    }
+
+    take(colorIndex, depthIndex, skewUs, colorFrame, depthFrame);
+    return true;
+}
+
+/**
+ * @brief 清空缓存
+ */
+void FramePairer::clear()
+{
+    colorQueue.clear();
+    depthQueue.clear();
+}
+
+/**
+ * @brief 获取时间差统计
+ */
+FrameSkewStats FramePairer::getStats() const
+{
+    return stats;
+}
+
+/**
+ * @brief 重置时间差统计
+ */
+void FramePairer::resetStats()
+{
+    stats = FrameSkewStats();
+    skewM2 = 0.0;
+}
@@ -0,0 +1,289 @@
+/**
+ * @file FramePipeline.cpp
+ * @author Guo1ZY 132872017@qq.com
+ * @brief 逐帧流水线处理实现
+ * @version 0.1
+ * @date 2025-01-15
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "FramePipeline.hpp"
+#include <iostream>
+
+/**
+ * @brief 构造函数
+ */
+FramePipeline::FramePipeline(size_t threadCount, size_t maxInFlight)
+    : nextSequence(0), nextOutput(0), processing(0), inFlight(0), maxInFlight(maxInFlight),
+      droppedCount(0), started(false), pool(threadCount)
+{
+    if (this->maxInFlight == 0)
+    {
+        this->maxInFlight = pool.size() * 2 + 2;
+    }
+}
+
+/**
+ * @brief 析构函数
+ */
+FramePipeline::~FramePipeline()
+{
+    flush();
+}
+
+/**
+ * @brief 添加阶段
+ */
+bool FramePipeline::addStage(const std::string &name, std::function<void(FramePacket &)> process, StageMode mode)
+{
+    std::lock_guard<std::mutex> lock(outputMutex);
+    if (started)
+    {
+        std::cerr << "FramePipeline: stages must be added before the first push" << std::endl;
+        return false;
+    }
+    if (!process)
+    {
+        std::cerr << "FramePipeline: stage " << name << " has no process function" << std::endl;
+        return false;
+    }
+
+    std::unique_ptr<Stage> stage(new Stage());
+    stage->name = name;
+    stage->process = process;
+    stage->mode = mode;
+    stage->nextSequence = 0;
+    stage->active = 0;
+    stage->processed = 0;
+    stage->busyMs = 0.0;
+    stages.push_back(std::move(stage));
+    return true;
+}
+
+/**
+ * @brief 推入一帧帧集
+ */
+bool FramePipeline::push(std::shared_ptr<ob::FrameSet> frameset, uint32_t timeoutMs)
+{
+    if (!frameset)
+    {
+        return false;
+    }
+
+    std::shared_ptr<FramePacket> packet = std::make_shared<FramePacket>();
+    packet->frameset = frameset;
+    packet->changeTileSize = 0;
+    {
+        std::unique_lock<std::mutex> lock(outputMutex);
+        if (!slotFree.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this]
+                               { return inFlight < maxInFlight; }))
+        {
+            droppedCount++;
+            return false;
+        }
+        if (!started)
+        {
+            started = true;
+            startTime = std::chrono::steady_clock::now();
+        }
+        packet->sequence = nextSequence++;
+        processing++;
+        inFlight++;
+    }
+
+    enqueue(0, packet);
+    return true;
+}
+
+/**
+ * @brief 按帧序取出一帧处理结果
+ */
+bool FramePipeline::pop(FramePacket &packet, uint32_t timeoutMs)
+{
+    std::unique_lock<std::mutex> lock(outputMutex);
+    if (!outputReady.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this]
+                              { return !output.empty(); }))
+    {
+        return false;
+    }
+
+    packet = std::move(*output.front());
+    output.pop_front();
+    inFlight--;
+    lock.unlock();
+    slotFree.notify_one();
+    return true;
+}
+
+/**
+ * @brief 等待所有已推入的帧处理完成
+ */
+void FramePipeline::flush()
+{
+    std::unique_lock<std::mutex> lock(outputMutex);
+    outputReady.wait(lock, [this]
+                     { return processing == 0; });
+}
+
+/**
+ * @brief 获取各阶段运行统计
+ */
+std::vector<StageStats> FramePipeline::getStats() const
+{
+    double elapsedMs = 0.0;
+    {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        if (started)
+        {
+            elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        }
+    }
+
+    std::vector<StageStats> stats(stages.size());
+    for (size_t i = 0; i < stages.size(); i++)
+    {
+        const Stage &stage = *stages[i];
+        std::lock_guard<std::mutex> lock(stage.mutex);
+        stats[i].name = stage.name;
+        stats[i].mode = stage.mode;
+        stats[i].queueDepth = stage.queue.size();
+        stats[i].active = stage.active;
+        stats[i].processed = stage.processed;
+        stats[i].meanTimeMs = stage.processed ? stage.busyMs / stage.processed : 0.0;
+        stats[i].occupancy = elapsedMs > 0 ? stage.busyMs / elapsedMs : 0.0;
+    }
+    return stats;
+}
+
+/**
+ * @brief 获取丢弃帧数
+ */
+uint64_t FramePipeline::getDroppedCount() const
+{
+    std::lock_guard<std::mutex> lock(outputMutex);
+    return droppedCount;
+}
+
+/**
+ * @brief 获取在途帧数上限
+ */
+size_t FramePipeline::getMaxInFlight() const
+{
+    return maxInFlight;
+}
+
+/**
+ * @brief 将帧放入指定阶段的队列
+ */
+void FramePipeline::enqueue(size_t stageIndex, std::shared_ptr<FramePacket> packet)
+{
+    if (stageIndex >= stages.size())
+    {
+        deliver(packet);
+        return;
+    }
+
+    {
+        Stage &stage = *stages[stageIndex];
+        std::lock_guard<std::mutex> lock(stage.mutex);
+        stage.queue[packet->sequence] = packet;
+    }
+    schedule(stageIndex);
+}
+
+/**
+ * @brief 从阶段队列中取出可执行的帧提交到线程池
+ */
+void FramePipeline::schedule(size_t stageIndex)
+{
+    Stage &stage = *stages[stageIndex];
+    std::vector<std::shared_ptr<FramePacket>> ready;
+    {
+        std::lock_guard<std::mutex> lock(stage.mutex);
+        if (stage.mode == StageMode::Serial)
+        {
+            // 串行阶段只处理下一个帧序号，前面的帧未到达时等待
+            if (stage.active == 0 && !stage.queue.empty() && stage.queue.begin()->first == stage.nextSequence)
+            {
+                ready.push_back(stage.queue.begin()->second);
+                stage.queue.erase(stage.queue.begin());
+                stage.active++;
+            }
+        }
+        else
+        {
+            // 并行阶段最多占用全部线程，剩余帧留在队列中以反映积压
+            while (!stage.queue.empty() && stage.active < pool.size())
+            {
+                ready.push_back(stage.queue.begin()->second);
+                stage.queue.erase(stage.queue.begin());
+                stage.active++;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < ready.size(); i++)
+    {
+        std::shared_ptr<FramePacket> packet = ready[i];
+        pool.submit([this, stageIndex, packet]
+                    { run(stageIndex, packet); });
+    }
+}
+
+/**
+ * @brief 执行一个阶段并转入下一阶段
+ */
+void FramePipeline::run(size_t stageIndex, std::shared_ptr<FramePacket> packet)
+{
+    Stage &stage = *stages[stageIndex];
+    auto start = std::chrono::steady_clock::now();
+
+    // 阶段出错时帧继续向后传递，保证后续串行阶段和输出的帧序连续
+    try
+    {
+        stage.process(*packet);
+    }
+    catch (const ob::Error &e)
+    {
+        std::cerr << "FramePipeline: stage " << stage.name << " error: " << e.getMessage() << std::endl;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "FramePipeline: stage " << stage.name << " exception: " << e.what() << std::endl;
+    }
+
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    {
+        std::lock_guard<std::mutex> lock(stage.mutex);
+        stage.active--;
+        stage.processed++;
+        stage.busyMs += elapsedMs;
+        if (stage.mode == StageMode::Serial)
+        {
+            stage.nextSequence = packet->sequence + 1;
+        }
+    }
+
+    enqueue(stageIndex + 1, packet);
+    schedule(stageIndex);
+}
+
+/**
+ * @brief 按帧序放入输出队列
+ */
+void FramePipeline::deliver(std::shared_ptr<FramePacket> packet)
+{
+    {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        reorder[packet->sequence] = packet;
+        while (!reorder.empty() && reorder.begin()->first == nextOutput)
+        {
+            output.push_back(reorder.begin()->second);
+            reorder.erase(reorder.begin());
+            nextOutput++;
+            processing--;
+        }
+    }
+    outputReady.notify_all();
+}
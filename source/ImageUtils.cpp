@@ -0,0 +1,107 @@
+/**
+ * @file ImageUtils.cpp
+ * @author Guo1ZY 132872017@qq.com
+ * @brief 图像缓冲池与相机内参缩放实现
+ * @version 0.1
+ * @date 2025-01-15
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "ImageUtils.hpp"
+#include <algorithm>
+
+/**
+ * @brief 按图像分辨率缩放相机内参
+ */
+OBCameraIntrinsic scaleIntrinsic(const OBCameraIntrinsic &intrinsic, const cv::Size &imageSize)
+{
+    float scaleX = intrinsic.width > 0 ? (float)imageSize.width / intrinsic.width : 1.0f;
+    float scaleY = intrinsic.height > 0 ? (float)imageSize.height / intrinsic.height : 1.0f;
+
+    OBCameraIntrinsic scaled = intrinsic;
+    scaled.fx = intrinsic.fx * scaleX;
+    scaled.fy = intrinsic.fy * scaleY;
+    scaled.cx = intrinsic.cx * scaleX;
+    scaled.cy = intrinsic.cy * scaleY;
+    scaled.width = (int16_t)imageSize.width;
+    scaled.height = (int16_t)imageSize.height;
+    return scaled;
+}
+
+/**
+ * @brief 构造函数
+ */
+BufferPool::BufferPool(size_t capacity)
+    : capacity(std::max<size_t>(1, capacity))
+{
+}
+
+/**
+ * @brief 设置缓冲池最大容量
+ */
+void BufferPool::setCapacity(size_t capacity)
+{
+    this->capacity = std::max<size_t>(1, capacity);
+    if (buffers.size() > this->capacity)
+    {
+        buffers.resize(this->capacity);
+    }
+}
+
+/**
+ * @brief 取出未被外部引用的缓冲区
+ */
+cv::Mat BufferPool::acquire(const cv::Size &size, int type)
+{
+    for (size_t i = 0; i < buffers.size(); i++)
+    {
+        cv::Mat &buffer = buffers[i];
+        // 引用计数为1表示只有缓冲池持有，调用方已释放
+        if (buffer.u && buffer.u->refcount == 1 && buffer.size() == size && buffer.type() == type)
+        {
+            return buffer;
+        }
+    }
+
+    cv::Mat buffer(size, type);
+    if (buffers.size() < capacity)
+    {
+        buffers.push_back(buffer);
+    }
+    else
+    {
+        // 替换尺寸或类型已不匹配的空闲缓冲
+        for (size_t i = 0; i < buffers.size(); i++)
+        {
+            if (buffers[i].u && buffers[i].u->refcount == 1)
+            {
+                buffers[i] = buffer;
+                break;
+            }
+        }
+    }
+    return buffer;
+}
+
+/**
+ * @brief 缓冲是否除缓冲池外只被调用方持有
+ */
+bool BufferPool::isIdle(const cv::Mat &buffer, int callerRefs) const
+{
+    if (!buffer.u)
+    {
+        return false;
+    }
+    // 池满时分配的缓冲不在池中，缓冲池不持有引用
+    int poolRefs = 0;
+    for (size_t i = 0; i < buffers.size(); i++)
+    {
+        if (buffers[i].u == buffer.u)
+        {
+            poolRefs = 1;
+            break;
+        }
+    }
+    return buffer.u->refcount == poolRefs + callerRefs;
+}
@@ -9,14 +9,165 @@
  *
  */
 #include "OrbbecDabai.hpp"
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 
+namespace
+{
+    /**
+     * @brief 将彩色帧解码为BGR图像，不使用共享的格式转换器，可在多个线程同时调用
+     */
+    bool decodeColorFrame(std::shared_ptr<ob::ColorFrame> colorFrame, cv::Mat &bgr)
+    {
+        if (!colorFrame)
+        {
+            return false;
+        }
+
+        void *data = colorFrame->data();
+        int width = colorFrame->width();
+        int height = colorFrame->height();
+        switch (colorFrame->format())
+        {
+        case OB_FORMAT_MJPG:
+            bgr = cv::imdecode(cv::Mat(1, (int)colorFrame->dataSize(), CV_8UC1, data), cv::IMREAD_COLOR);
+            break;
+        case OB_FORMAT_YUYV:
+            cv::cvtColor(cv::Mat(height, width, CV_8UC2, data), bgr, cv::COLOR_YUV2BGR_YUYV);
+            break;
+        case OB_FORMAT_UYVY:
+            cv::cvtColor(cv::Mat(height, width, CV_8UC2, data), bgr, cv::COLOR_YUV2BGR_UYVY);
+            break;
+        case OB_FORMAT_RGB:
+            cv::cvtColor(cv::Mat(height, width, CV_8UC3, data), bgr, cv::COLOR_RGB2BGR);
+            break;
+        case OB_FORMAT_BGR:
+            bgr = cv::Mat(height, width, CV_8UC3, data);
+            break;
+        default:
+            return false;
+        }
+        return !bgr.empty();
+    }
+
+    // 点云阶段无变化掩码时的分块边长
+    const int kPointCloudTileSize = 32;
+
+    /**
+     * @brief 去畸变阶段: 使用自己的去畸变器，不与取图接口共享映射表和缓冲池
+     */
+    struct UndistortStage
+    {
+        Undistorter color;
+        Undistorter depth;
+        Undistorter ir;
+
+        UndistortStage()
+            : color(cv::INTER_LINEAR), depth(cv::INTER_NEAREST), ir(cv::INTER_LINEAR)
+        {
+        }
+    };
+
+    /**
+     * @brief 点云阶段: 有变化掩码时只重算变化块，输出缓冲在多帧之间复用
+     */
+    class PointCloudBuilder
+    {
+    public:
+        PointCloudBuilder(const OBCameraIntrinsic &intrinsic, float depthScale, size_t poolSize)
+            : intrinsic(intrinsic), depthScale(depthScale), pool(poolSize)
+        {
+        }
+
+        void process(FramePacket &packet)
+        {
+            const cv::Mat &depth = packet.depth;
+            if (depth.empty())
+            {
+                return;
+            }
+
+            // 内参标定分辨率与深度图分辨率不同时按比例缩放
+            const OBCameraIntrinsic scaled = scaleIntrinsic(intrinsic, depth.size());
+            const float fx = scaled.fx;
+            const float fy = scaled.fy;
+            const float cx = scaled.cx;
+            const float cy = scaled.cy;
+
+            // 掩码与深度图分块一致且有同尺寸的上一帧点云时，未变化块沿用上一帧
+            const int tileSize = packet.changeTileSize > 0 ? packet.changeTileSize : kPointCloudTileSize;
+            const cv::Mat &mask = packet.changeMask;
+            const bool useMask = !mask.empty() && packet.changeTileSize > 0 && previous.size() == depth.size() &&
+                                 mask.cols == (depth.cols + tileSize - 1) / tileSize &&
+                                 mask.rows == (depth.rows + tileSize - 1) / tileSize;
+
+            // 上一帧点云只剩本对象持有时原地更新，未变化块无需任何写入; 否则取新缓冲并从上一帧拷贝未变化块
+            const bool inPlace = useMask && pool.isIdle(previous, 1);
+            cv::Mat cloud = inPlace ? previous : pool.acquire(depth.size(), CV_32FC3);
+            const bool copyUnchanged = useMask && !inPlace;
+
+            const int tileRows = (depth.rows + tileSize - 1) / tileSize;
+            const int tileCols = (depth.cols + tileSize - 1) / tileSize;
+            const float scale = depthScale;
+            cv::parallel_for_(cv::Range(0, tileRows), [&](const cv::Range &range)
+            {
+                for (int ty = range.start; ty < range.end; ty++)
+                {
+                    const int rowBegin = ty * tileSize;
+                    const int rowEnd = std::min(depth.rows, rowBegin + tileSize);
+                    const uchar *maskRow = useMask ? mask.ptr<uchar>(ty) : nullptr;
+                    for (int tx = 0; tx < tileCols; tx++)
+                    {
+                        const int colBegin = tx * tileSize;
+                        const int colEnd = std::min(depth.cols, colBegin + tileSize);
+                        if (useMask && !maskRow[tx])
+                        {
+                            if (copyUnchanged)
+                            {
+                                cv::Rect tile(colBegin, rowBegin, colEnd - colBegin, rowEnd - rowBegin);
+                                previous(tile).copyTo(cloud(tile));
+                            }
+                            continue;
+                        }
+
+                        // 无效深度输出(0,0,0)
+                        for (int v = rowBegin; v < rowEnd; v++)
+                        {
+                            const uint16_t *depthRow = depth.ptr<uint16_t>(v);
+                            cv::Vec3f *pointRow = cloud.ptr<cv::Vec3f>(v);
+                            const float y = (v - cy) / fy;
+                            for (int u = colBegin; u < colEnd; u++)
+                            {
+                                float z = depthRow[u] * scale;
+                                pointRow[u] = cv::Vec3f((u - cx) / fx * z, y * z, z);
+                            }
+                        }
+                    }
+                }
+            });
+
+            previous = cloud;
+            packet.pointCloud = cloud;
+        }
+
+    private:
+        OBCameraIntrinsic intrinsic;
+        float depthScale;
+        BufferPool pool;
+        cv::Mat previous;
+    };
+}
+
 /**
  * @brief 构造函数
  */
 OrbbecDabai::OrbbecDabai()
     : isInitialized(false), isRunning(false), depthScale(0.001f),
-      colorWidth(1280), colorHeight(720), depthWidth(640), depthHeight(480)
+      colorWidth(1280), colorHeight(720), depthWidth(640), depthHeight(480), irWidth(640), irHeight(480),
+      pairMode(PairMode::WaitForMatch), pairTimeoutMs(200), cameraParam(), hasCameraParam(false),
+      lastChangeSource(-1), changeDetectionEnabled(false),
+      colorUndistorter(cv::INTER_LINEAR), depthUndistorter(cv::INTER_NEAREST), irUndistorter(cv::INTER_LINEAR)
 {
 }
 
@@ -89,6 +240,13 @@ void OrbbecDabai::init()
         {
             auto irProfile = irProfiles->getVideoStreamProfile();
             config->enableStream(irProfile);
+            irWidth = irProfile->width();
+            irHeight = irProfile->height();
+        }
+        else
+        {
+            irWidth = 0;
+            irHeight = 0;
         }
 
         // 设置对齐模式（深度对齐到彩色）
@@ -98,6 +256,21 @@ void OrbbecDabai::init()
         pipeline->start(config);
         isRunning = true;
 
+        // 获取相机内参和畸变系数，用于去畸变
+        try
+        {
+            cameraParam = pipeline->getCameraParam();
+            hasCameraParam = true;
+            colorUndistorter.setParams(cameraParam.rgbIntrinsic, cameraParam.rgbDistortion);
+            // 深度已对齐到彩色图像坐标系，使用彩色相机参数
+            depthUndistorter.setParams(cameraParam.rgbIntrinsic, cameraParam.rgbDistortion);
+            irUndistorter.setParams(cameraParam.depthIntrinsic, cameraParam.depthDistortion);
+        }
+        catch (const ob::Error &e)
+        {
+            std::cerr << "Failed to get camera parameters, undistortion disabled: " << e.getMessage() << std::endl;
+        }
+
         // 获取深度缩放因子
         // try
         // {
@@ -222,6 +395,10 @@ bool OrbbecDabai::updateFrameset(uint32_t timeout_ms)
     try
     {
         currentFrameset = pipeline->waitForFrames(timeout_ms);
+        if (currentFrameset && history)
+        {
+            history->push(currentFrameset);
+        }
         return currentFrameset != nullptr;
     }
     catch (const ob::Error &e)
@@ -231,6 +408,352 @@ bool OrbbecDabai::updateFrameset(uint32_t timeout_ms)
     }
 }
 
+/**
+ * @brief 获取按时间戳配对的彩色帧和深度帧
+ */
+bool OrbbecDabai::updatePairedFrames(std::shared_ptr<ob::ColorFrame> &colorFrame, std::shared_ptr<ob::DepthFrame> &depthFrame)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(pairTimeoutMs);
+
+    while (true)
+    {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0 || !updateFrameset((uint32_t)remaining))
+        {
+            break;
+        }
+        framePairer.push(currentFrameset);
+
+        if (framePairer.pop(colorFrame, depthFrame))
+        {
+            return true;
+        }
+        if (pairMode == PairMode::BestEffort)
+        {
+            break;
+        }
+    }
+
+    // 超时或BestEffort模式: 返回时间差最小的配对
+    if (pairMode == PairMode::BestEffort && framePairer.popBest(colorFrame, depthFrame))
+    {
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief 设置彩色/深度帧配对方式
+ */
+void OrbbecDabai::setFramePairing(PairMode mode, uint64_t toleranceUs, uint32_t timeoutMs)
+{
+    pairMode = mode;
+    pairTimeoutMs = timeoutMs;
+    framePairer.setTolerance(toleranceUs);
+    framePairer.clear();
+}
+
+/**
+ * @brief 获取彩色/深度帧时间差统计
+ */
+FrameSkewStats OrbbecDabai::getFrameSkewStats() const
+{
+    return framePairer.getStats();
+}
+
+/**
+ * @brief 获取相机内参和畸变系数
+ */
+bool OrbbecDabai::getCameraParam(OBCameraParam &param) const
+{
+    if (!hasCameraParam)
+    {
+        return false;
+    }
+    param = cameraParam;
+    return true;
+}
+
+/**
+ * @brief 获取一帧对齐的彩色和深度图像并融合到TSDF体积
+ */
+bool OrbbecDabai::integrateTsdf(TsdfVolume &volume, const cv::Matx44f &cameraPose)
+{
+    if (!hasCameraParam)
+    {
+        std::cerr << "Camera parameters unavailable, cannot integrate TSDF!" << std::endl;
+        return false;
+    }
+
+    std::shared_ptr<ob::ColorFrame> colorFrame;
+    std::shared_ptr<ob::DepthFrame> depthFrame;
+
+    try
+    {
+        if (!updatePairedFrames(colorFrame, depthFrame))
+        {
+            return false;
+        }
+
+        // 直接引用SDK帧内存，无需拷贝
+        colorFrame = convertColorToBGR(colorFrame);
+        cv::Mat colorMat(colorFrame->height(), colorFrame->width(), CV_8UC3, colorFrame->data());
+        cv::Mat depthMat(depthFrame->height(), depthFrame->width(), CV_16UC1, depthFrame->data());
+
+        // 深度已对齐到彩色图像坐标系，使用彩色相机内参; 变化检测的参考帧由体积自己保存
+        return volume.integrate(depthMat, colorMat, cameraParam.rgbIntrinsic, cameraPose, depthScale);
+    }
+    catch (const ob::Error &e)
+    {
+        std::cerr << "Error integrating TSDF: " << e.getMessage() << std::endl;
+    }
+    return false;
+}
+
+/**
+ * @brief 开启或关闭分块变化检测
+ */
+void OrbbecDabai::setChangeDetection(bool enable, int tileSize)
+{
+    for (int i = 0; i < CHANGE_SOURCE_COUNT; i++)
+    {
+        changeDetectors[i].setTileSize(tileSize);
+    }
+    lastChangeSource = -1;
+    changeDetectionEnabled = enable;
+}
+
+/**
+ * @brief 设置变化检测滞回阈值
+ */
+void OrbbecDabai::setChangeThresholds(float depthHigh, float depthLow, float colorHigh, float colorLow)
+{
+    for (int i = 0; i < CHANGE_SOURCE_COUNT; i++)
+    {
+        changeDetectors[i].setThresholds(depthHigh, depthLow, colorHigh, colorLow);
+    }
+}
+
+/**
+ * @brief 获取最近一次取图对应的变化掩码
+ */
+cv::Mat OrbbecDabai::getChangeMask() const
+{
+    if (!changeDetectionEnabled || lastChangeSource < 0)
+    {
+        return cv::Mat();
+    }
+    return changeDetectors[lastChangeSource].getMask().clone();
+}
+
+/**
+ * @brief 用新取得的图像更新变化掩码
+ */
+void OrbbecDabai::updateChangeMask(ChangeSource source, const cv::Mat &colorImg, const cv::Mat &depthImg)
+{
+    if (changeDetectionEnabled)
+    {
+        changeDetectors[source].update(colorImg, depthImg);
+        lastChangeSource = source;
+    }
+}
+
+/**
+ * @brief 开启帧历史环形缓冲
+ */
+void OrbbecDabai::enableHistory(size_t budgetBytes)
+{
+    history.reset();
+    if (budgetBytes == 0)
+    {
+        return;
+    }
+
+    // 深度对齐到彩色后与彩色同分辨率，按较大者预留; 红外不参与对齐，按红外分辨率预留;
+    // 压缩彩色按每像素0.5字节预留
+    size_t colorPixels = (size_t)colorWidth * colorHeight;
+    size_t depthPixels = std::max(colorPixels, (size_t)depthWidth * depthHeight);
+    size_t irPixels = (size_t)irWidth * irHeight;
+    history.reset(new FrameHistory(budgetBytes, colorPixels / 2, depthPixels * 2, irPixels * 2));
+
+    std::cout << "Frame history: " << history->getSlotCount() << " slots in "
+              << budgetBytes / (1024 * 1024) << " MB" << std::endl;
+}
+
+/**
+ * @brief 触发事件保存
+ */
+bool OrbbecDabai::trigger(double preSeconds, double postSeconds, const std::string &prefix)
+{
+    if (!history)
+    {
+        std::cerr << "Frame history not enabled!" << std::endl;
+        return false;
+    }
+    return history->trigger(preSeconds, postSeconds, prefix);
+}
+
+/**
+ * @brief 获取一帧深度并转换为虚拟激光扫描
+ */
+bool OrbbecDabai::getLaserScan(VirtualScan &scanner, LaserScan &scan)
+{
+    if (!hasCameraParam)
+    {
+        std::cerr << "Camera parameters unavailable, cannot compute laser scan!" << std::endl;
+        return false;
+    }
+    if (!updateFrameset())
+    {
+        return false;
+    }
+
+    try
+    {
+        auto depthFrame = currentFrameset->depthFrame();
+        if (depthFrame)
+        {
+            // 直接引用SDK帧内存; 深度已对齐到彩色图像坐标系，使用彩色相机内参
+            cv::Mat depthMat(depthFrame->height(), depthFrame->width(), CV_16UC1, depthFrame->data());
+            scanner.setIntrinsic(cameraParam.rgbIntrinsic);
+            return scanner.convert(depthMat, scan, depthScale);
+        }
+    }
+    catch (const ob::Error &e)
+    {
+        std::cerr << "Error getting laser scan: " << e.getMessage() << std::endl;
+    }
+    return false;
+}
+
+/**
+ * @brief 获取一帧帧集并推入流水线
+ */
+bool OrbbecDabai::feedPipeline(FramePipeline &pipeline, uint32_t timeoutMs)
+{
+    if (!updateFrameset(timeoutMs))
+    {
+        return false;
+    }
+    return pipeline.push(currentFrameset, timeoutMs);
+}
+
+/**
+ * @brief 添加格式转换阶段
+ */
+bool OrbbecDabai::addConvertStage(FramePipeline &pipeline)
+{
+    return pipeline.addStage("convert", [](FramePacket &packet)
+                             {
+        decodeColorFrame(packet.frameset->colorFrame(), packet.color);
+
+        // 帧集由FramePacket持有，深度和红外直接引用帧内存，省去拷贝
+        auto depthFrame = packet.frameset->depthFrame();
+        if (depthFrame)
+        {
+            packet.depth = cv::Mat(depthFrame->height(), depthFrame->width(), CV_16UC1, depthFrame->data());
+        }
+        auto irFrame = packet.frameset->irFrame();
+        if (irFrame)
+        {
+            packet.ir = cv::Mat(irFrame->height(), irFrame->width(), CV_16UC1, irFrame->data());
+        } }, StageMode::Parallel);
+}
+
+/**
+ * @brief 添加去畸变阶段
+ */
+bool OrbbecDabai::addUndistortStage(FramePipeline &pipeline)
+{
+    if (!hasCameraParam)
+    {
+        std::cerr << "Camera parameters unavailable, cannot undistort!" << std::endl;
+        return false;
+    }
+
+    // 阶段使用自己的去畸变器，与取图接口互不干扰; 深度已对齐到彩色图像坐标系，使用彩色相机参数
+    std::shared_ptr<UndistortStage> stage = std::make_shared<UndistortStage>();
+    stage->color.setParams(cameraParam.rgbIntrinsic, cameraParam.rgbDistortion);
+    stage->depth.setParams(cameraParam.rgbIntrinsic, cameraParam.rgbDistortion);
+    stage->ir.setParams(cameraParam.depthIntrinsic, cameraParam.depthDistortion);
+
+    // 每个在途帧持有一份输出，另留一份给调用方取出后仍持有的帧
+    size_t poolSize = pipeline.getMaxInFlight() + 1;
+    stage->color.setPoolSize(poolSize);
+    stage->depth.setPoolSize(poolSize);
+    stage->ir.setPoolSize(poolSize);
+
+    // 映射表和缓冲池不是线程安全的，按串行阶段执行
+    return pipeline.addStage("undistort", [stage](FramePacket &packet)
+                             {
+        if (!packet.color.empty())
+        {
+            packet.color = stage->color.undistort(packet.color);
+        }
+        if (!packet.depth.empty())
+        {
+            packet.depth = stage->depth.undistort(packet.depth);
+        }
+        if (!packet.ir.empty())
+        {
+            packet.ir = stage->ir.undistort(packet.ir);
+        } }, StageMode::Serial);
+}
+
+/**
+ * @brief 添加分块变化检测阶段
+ */
+bool OrbbecDabai::addChangeDetectionStage(FramePipeline &pipeline, ChangeDetector &detector)
+{
+    // 使用独立的检测器，不与取图接口共享参考帧; 与上一帧比较，必须按帧序串行执行
+    return pipeline.addStage("changeDetection", [&detector](FramePacket &packet)
+                             {
+        packet.changeMask = detector.update(packet.color, packet.depth).clone();
+        packet.changeTileSize = detector.getTileSize(); }, StageMode::Serial);
+}
+
+/**
+ * @brief 添加有序点云阶段
+ */
+bool OrbbecDabai::addPointCloudStage(FramePipeline &pipeline)
+{
+    if (!hasCameraParam)
+    {
+        std::cerr << "Camera parameters unavailable, cannot compute point cloud!" << std::endl;
+        return false;
+    }
+
+    // 每个在途帧持有一份点云，另留出阶段保存的上一帧和调用方取出后仍持有的帧
+    size_t poolSize = pipeline.getMaxInFlight() + 2;
+
+    // 深度已对齐到彩色图像坐标系，使用彩色相机内参; 沿用上一帧点云，按帧序串行执行
+    std::shared_ptr<PointCloudBuilder> builder = std::make_shared<PointCloudBuilder>(cameraParam.rgbIntrinsic, depthScale, poolSize);
+    return pipeline.addStage("pointCloud", [builder](FramePacket &packet)
+                             { builder->process(packet); }, StageMode::Serial);
+}
+
+/**
+ * @brief 添加虚拟激光扫描阶段
+ */
+bool OrbbecDabai::addLaserScanStage(FramePipeline &pipeline, VirtualScan &scanner)
+{
+    if (!hasCameraParam)
+    {
+        std::cerr << "Camera parameters unavailable, cannot compute laser scan!" << std::endl;
+        return false;
+    }
+
+    // 转换器复用内部缓冲，按串行阶段执行
+    scanner.setIntrinsic(cameraParam.rgbIntrinsic);
+    float scale = depthScale;
+    return pipeline.addStage("laserScan", [&scanner, scale](FramePacket &packet)
+                             {
+        if (!packet.depth.empty())
+        {
+            scanner.convert(packet.depth, packet.scan, scale);
+        } }, StageMode::Serial);
+}
+
 /**
  * @brief 转换颜色帧格式为BGR
  */
@@ -266,10 +789,23 @@ std::shared_ptr<ob::ColorFrame> OrbbecDabai::convertColorToBGR(std::shared_ptr<o
     return formatConverter.process(colorFrame)->as<ob::ColorFrame>();
 }
 
+/**
+ * @brief 生成输出图像
+ */
+cv::Mat OrbbecDabai::outputImage(const cv::Mat &frameMat, bool undistort, Undistorter &undistorter)
+{
+    // 去畸变直接从SDK帧内存remap到池化缓冲，省去一次拷贝
+    if (undistort && undistorter.isConfigured())
+    {
+        return undistorter.undistort(frameMat);
+    }
+    return frameMat.clone();
+}
+
 /**
  * @brief 获取图像 (彩色、深度、红外)
  */
-std::vector<cv::Mat> OrbbecDabai::getImg()
+std::vector<cv::Mat> OrbbecDabai::getImg(bool undistort)
 {
     std::vector<cv::Mat> images;
 
@@ -286,7 +822,7 @@ std::vector<cv::Mat> OrbbecDabai::getImg()
         {
             colorFrame = convertColorToBGR(colorFrame);
             cv::Mat colorMat(colorFrame->height(), colorFrame->width(), CV_8UC3, colorFrame->data());
-            images.push_back(colorMat.clone());
+            images.push_back(outputImage(colorMat, undistort, colorUndistorter));
         }
         else
         {
@@ -298,7 +834,7 @@ std::vector<cv::Mat> OrbbecDabai::getImg()
         if (depthFrame)
         {
             cv::Mat depthMat(depthFrame->height(), depthFrame->width(), CV_16UC1, depthFrame->data());
-            images.push_back(depthMat.clone());
+            images.push_back(outputImage(depthMat, undistort, depthUndistorter));
         }
         else
         {
@@ -310,7 +846,7 @@ std::vector<cv::Mat> OrbbecDabai::getImg()
         if (irFrame)
         {
             cv::Mat irMat(irFrame->height(), irFrame->width(), CV_16UC1, irFrame->data());
-            images.push_back(irMat.clone());
+            images.push_back(outputImage(irMat, undistort, irUndistorter));
         }
         else
         {
@@ -322,13 +858,17 @@ std::vector<cv::Mat> OrbbecDabai::getImg()
         std::cerr << "Error getting images: " << e.getMessage() << std::endl;
     }
 
+    if (images.size() >= 2)
+    {
+        updateChangeMask(CHANGE_IMG, images[0], images[1]);
+    }
     return images;
 }
 
 /**
  * @brief 获取彩色图像
  */
-cv::Mat OrbbecDabai::getColorImg()
+cv::Mat OrbbecDabai::getColorImg(bool undistort)
 {
     if (!updateFrameset())
     {
@@ -342,7 +882,9 @@ cv::Mat OrbbecDabai::getColorImg()
         {
             colorFrame = convertColorToBGR(colorFrame);
             cv::Mat colorMat(colorFrame->height(), colorFrame->width(), CV_8UC3, colorFrame->data());
-            return colorMat.clone();
+            cv::Mat colorImg = outputImage(colorMat, undistort, colorUndistorter);
+            updateChangeMask(CHANGE_COLOR, colorImg, cv::Mat());
+            return colorImg;
         }
     }
     catch (const ob::Error &e)
@@ -356,7 +898,7 @@ cv::Mat OrbbecDabai::getColorImg()
 /**
  * @brief 获取深度图像
  */
-cv::Mat OrbbecDabai::getDepthImg()
+cv::Mat OrbbecDabai::getDepthImg(bool undistort)
 {
     if (!updateFrameset())
     {
@@ -369,7 +911,9 @@ cv::Mat OrbbecDabai::getDepthImg()
         if (depthFrame)
         {
             cv::Mat depthMat(depthFrame->height(), depthFrame->width(), CV_16UC1, depthFrame->data());
-            return depthMat.clone();
+            cv::Mat depthImg = outputImage(depthMat, undistort, depthUndistorter);
+            updateChangeMask(CHANGE_DEPTH, cv::Mat(), depthImg);
+            return depthImg;
         }
     }
     catch (const ob::Error &e)
@@ -383,7 +927,7 @@ cv::Mat OrbbecDabai::getDepthImg()
 /**
  * @brief 获取红外图像
  */
-cv::Mat OrbbecDabai::getIRImg()
+cv::Mat OrbbecDabai::getIRImg(bool undistort)
 {
     if (!updateFrameset())
     {
@@ -396,7 +940,7 @@ cv::Mat OrbbecDabai::getIRImg()
         if (irFrame)
         {
             cv::Mat irMat(irFrame->height(), irFrame->width(), CV_16UC1, irFrame->data());
-            return irMat.clone();
+            return outputImage(irMat, undistort, irUndistorter);
         }
     }
     catch (const ob::Error &e)
@@ -410,7 +954,7 @@ cv::Mat OrbbecDabai::getIRImg()
 /**
  * @brief 获取指定像素点的深度值
  */
-float OrbbecDabai::getDepthAt(int x, int y)
+float OrbbecDabai::getDepthAt(int x, int y, bool undistort)
 {
     if (!updateFrameset())
     {
@@ -425,6 +969,19 @@ float OrbbecDabai::getDepthAt(int x, int y)
             int width = depthFrame->width();
             int height = depthFrame->height();
 
+            // 去畸变坐标映射回原始图像坐标 (最近邻)
+            if (undistort && depthUndistorter.isConfigured())
+            {
+                int srcX = 0;
+                int srcY = 0;
+                if (!depthUndistorter.mapPoint(cv::Size(width, height), x, y, srcX, srcY))
+                {
+                    return 0.0f;
+                }
+                x = srcX;
+                y = srcY;
+            }
+
             if (x >= 0 && x < width && y >= 0 && y < height)
             {
                 uint16_t *depthData = (uint16_t *)depthFrame->data();
@@ -444,41 +1001,31 @@ float OrbbecDabai::getDepthAt(int x, int y)
 /**
  * @brief 获取对齐的彩色图像和深度图像
  */
-void OrbbecDabai::getAlignedImages(cv::Mat &colorImg, cv::Mat &depthImg)
+void OrbbecDabai::getAlignedImages(cv::Mat &colorImg, cv::Mat &depthImg, bool undistort)
 {
-    if (!updateFrameset())
-    {
-        colorImg = cv::Mat();
-        depthImg = cv::Mat();
-        return;
-    }
+    std::shared_ptr<ob::ColorFrame> colorFrame;
+    std::shared_ptr<ob::DepthFrame> depthFrame;
 
     try
     {
-        // 获取彩色图像
-        auto colorFrame = currentFrameset->colorFrame();
-        if (colorFrame)
-        {
-            colorFrame = convertColorToBGR(colorFrame);
-            cv::Mat colorMat(colorFrame->height(), colorFrame->width(), CV_8UC3, colorFrame->data());
-            colorImg = colorMat.clone();
-        }
-        else
+        // 按设备时间戳配对，避免帧集缺流或时间错位
+        if (!updatePairedFrames(colorFrame, depthFrame))
         {
             colorImg = cv::Mat();
+            depthImg = cv::Mat();
+            return;
         }
 
+        // 获取彩色图像
+        colorFrame = convertColorToBGR(colorFrame);
+        cv::Mat colorMat(colorFrame->height(), colorFrame->width(), CV_8UC3, colorFrame->data());
+        colorImg = outputImage(colorMat, undistort, colorUndistorter);
+
         // 获取深度图像 (已经对齐到彩色图像)
-        auto depthFrame = currentFrameset->depthFrame();
-        if (depthFrame)
-        {
-            cv::Mat depthMat(depthFrame->height(), depthFrame->width(), CV_16UC1, depthFrame->data());
-            depthImg = depthMat.clone();
-        }
-        else
-        {
-            depthImg = cv::Mat();
-        }
+        cv::Mat depthMat(depthFrame->height(), depthFrame->width(), CV_16UC1, depthFrame->data());
+        depthImg = outputImage(depthMat, undistort, depthUndistorter);
+
+        updateChangeMask(CHANGE_ALIGNED, colorImg, depthImg);
     }
     catch (const ob::Error &e)
     {
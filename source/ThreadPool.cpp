@@ -0,0 +1,150 @@
+/**
+ * @file ThreadPool.cpp
+ * @author Guo1ZY 132872017@qq.com
+ * @brief 工作窃取线程池实现
+ * @version 0.1
+ * @date 2025-01-15
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+namespace
+{
+    // 当前线程所属的线程池及队列下标，用于识别工作线程内的提交
+    thread_local const ThreadPool *currentPool = nullptr;
+    thread_local size_t currentIndex = 0;
+}
+
+/**
+ * @brief 构造函数
+ */
+ThreadPool::ThreadPool(size_t threadCount)
+    : pending(0), nextQueue(0), stopping(false)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (size_t i = 0; i < threadCount; i++)
+    {
+        queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+    }
+    for (size_t i = 0; i < threadCount; i++)
+    {
+        threads.push_back(std::thread(&ThreadPool::workerLoop, this, i));
+    }
+}
+
+/**
+ * @brief 析构函数
+ */
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+        if (threads[i].joinable())
+        {
+            threads[i].join();
+        }
+    }
+}
+
+/**
+ * @brief 提交任务
+ */
+void ThreadPool::submit(std::function<void()> task)
+{
+    // 工作线程内提交到自己的队列，外部提交轮流分配
+    size_t index = currentPool == this ? currentIndex : nextQueue++ % queues.size();
+
+    // 先计数再入队: 任务一旦可见就可能被取走并递减，先入队会使计数短暂下溢
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        pending++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    wake.notify_one();
+}
+
+/**
+ * @brief 获取线程数
+ */
+size_t ThreadPool::size() const
+{
+    return threads.size();
+}
+
+/**
+ * @brief 从本线程队列尾部取任务
+ */
+bool ThreadPool::popLocal(size_t index, std::function<void()> &task)
+{
+    WorkQueue &queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+    {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+/**
+ * @brief 从其他线程队列头部窃取任务
+ */
+bool ThreadPool::steal(size_t index, std::function<void()> &task)
+{
+    for (size_t n = 1; n < queues.size(); n++)
+    {
+        WorkQueue &queue = *queues[(index + n) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 工作线程主循环
+ */
+void ThreadPool::workerLoop(size_t index)
+{
+    currentPool = this;
+    currentIndex = index;
+
+    while (true)
+    {
+        std::function<void()> task;
+        if (popLocal(index, task) || steal(index, task))
+        {
+            pending--;
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this]
+                  { return stopping || pending > 0; });
+        if (stopping && pending == 0)
+        {
+            return;
+        }
+    }
+}
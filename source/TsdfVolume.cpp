@@ -0,0 +1,648 @@
+/**
+ * @file TsdfVolume.cpp
+ * @author Guo1ZY 132872017@qq.com
+ * @brief 基于体素哈希的增量TSDF融合实现
+ * @version 0.1
+ * @date 2025-01-15
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "TsdfVolume.hpp"
+#include "ImageUtils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    // 块坐标每轴21位，偏移后为非负数
+    const int kKeyBits = 21;
+    const int kKeyOffset = 1 << (kKeyBits - 1);
+    const uint64_t kKeyMask = (1ull << kKeyBits) - 1;
+
+    const float kTsdfScale = 32767.0f;
+
+    /**
+     * @brief 向下取整除法 (负数同样向下取整)
+     */
+    inline int floorDiv(int value, int divisor)
+    {
+        return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+    }
+}
+
+/**
+ * @brief 构造函数，按块预算预分配块池
+ */
+TsdfVolume::TsdfVolume(const TsdfParams &params)
+    : params(params), usedBlocks(0), droppedBlocks(0), frameIndex(0), changeDetectionEnabled(false), hasLastPose(false)
+{
+    voxelPool.resize(params.maxBlocks * BLOCK_VOXELS, Voxel());
+    blockLastVisible.resize(params.maxBlocks, 0);
+    blockKeys.resize(params.maxBlocks, 0);
+    blockMap.reserve(params.maxBlocks);
+    visibleBlocks.reserve(params.maxBlocks);
+}
+
+/**
+ * @brief 清空体积
+ */
+void TsdfVolume::reset()
+{
+    std::fill(voxelPool.begin(), voxelPool.begin() + usedBlocks * BLOCK_VOXELS, Voxel());
+    std::fill(blockLastVisible.begin(), blockLastVisible.end(), 0);
+    blockMap.clear();
+    usedBlocks = 0;
+    droppedBlocks = 0;
+    frameIndex = 0;
+
+    // 体积已清空，下一帧必须整帧融合
+    changes.reset();
+    hasLastPose = false;
+}
+
+/**
+ * @brief 开启或关闭分块变化检测
+ */
+void TsdfVolume::setChangeDetection(bool enable, int tileSize)
+{
+    changes.setTileSize(tileSize);
+    changeDetectionEnabled = enable;
+    hasLastPose = false;
+}
+
+/**
+ * @brief 设置变化检测滞回阈值
+ */
+void TsdfVolume::setChangeThresholds(float depthHigh, float depthLow, float colorHigh, float colorLow)
+{
+    changes.setThresholds(depthHigh, depthLow, colorHigh, colorLow);
+}
+
+/**
+ * @brief 块坐标打包为哈希键
+ */
+uint64_t TsdfVolume::packKey(int x, int y, int z)
+{
+    return ((uint64_t)(x + kKeyOffset) & kKeyMask) |
+           (((uint64_t)(y + kKeyOffset) & kKeyMask) << kKeyBits) |
+           (((uint64_t)(z + kKeyOffset) & kKeyMask) << (2 * kKeyBits));
+}
+
+/**
+ * @brief 哈希键解包为块坐标
+ */
+void TsdfVolume::unpackKey(uint64_t key, int &x, int &y, int &z)
+{
+    x = (int)(key & kKeyMask) - kKeyOffset;
+    y = (int)((key >> kKeyBits) & kKeyMask) - kKeyOffset;
+    z = (int)((key >> (2 * kKeyBits)) & kKeyMask) - kKeyOffset;
+}
+
+/**
+ * @brief 查找或分配体素块
+ */
+int TsdfVolume::allocateBlock(uint64_t key)
+{
+    auto it = blockMap.find(key);
+    if (it != blockMap.end())
+    {
+        return it->second;
+    }
+
+    if (usedBlocks >= params.maxBlocks)
+    {
+        droppedBlocks++;
+        return -1;
+    }
+
+    int index = (int)usedBlocks++;
+    blockKeys[index] = key;
+    blockMap.emplace(key, index);
+    return index;
+}
+
+/**
+ * @brief 按全局体素坐标查找体素
+ */
+const TsdfVolume::Voxel *TsdfVolume::findVoxel(int x, int y, int z) const
+{
+    int bx = floorDiv(x, BLOCK_SIZE);
+    int by = floorDiv(y, BLOCK_SIZE);
+    int bz = floorDiv(z, BLOCK_SIZE);
+    auto it = blockMap.find(packKey(bx, by, bz));
+    if (it == blockMap.end())
+    {
+        return nullptr;
+    }
+
+    int lx = x - bx * BLOCK_SIZE;
+    int ly = y - by * BLOCK_SIZE;
+    int lz = z - bz * BLOCK_SIZE;
+    return &voxelPool[(size_t)it->second * BLOCK_VOXELS + (lz * BLOCK_SIZE + ly) * BLOCK_SIZE + lx];
+}
+
+/**
+ * @brief 融合一帧深度 (和可选的彩色) 图像
+ */
+bool TsdfVolume::integrate(const cv::Mat &depthImg, const cv::Mat &colorImg, const OBCameraIntrinsic &intrinsic,
+                           const cv::Matx44f &cameraPose, float depthScale)
+{
+    if (depthImg.empty() || depthImg.type() != CV_16UC1)
+    {
+        std::cerr << "TsdfVolume: depth image must be a non-empty CV_16UC1 image" << std::endl;
+        return false;
+    }
+    const bool useColor = !colorImg.empty() && colorImg.type() == CV_8UC3 && colorImg.size() == depthImg.size();
+
+    const OBCameraIntrinsic scaled = scaleIntrinsic(intrinsic, depthImg.size());
+    const float fx = scaled.fx;
+    const float fy = scaled.fy;
+    const float cx = scaled.cx;
+    const float cy = scaled.cy;
+    if (fx <= 0 || fy <= 0)
+    {
+        std::cerr << "TsdfVolume: invalid camera intrinsic" << std::endl;
+        return false;
+    }
+
+    // 变化掩码按深度图像分块; 位姿与上一次融合不同时，图像未变化的块也可能对应新的世界区域，
+    // 此时清空参考帧并整帧融合，本帧成为新的参考帧
+    cv::Mat changeMask;
+    int tileSize = 1;
+    if (changeDetectionEnabled)
+    {
+        const bool samePose = hasLastPose && cameraPose == lastPose;
+        if (!samePose)
+        {
+            changes.reset();
+        }
+        changes.update(useColor ? colorImg : cv::Mat(), depthImg);
+        if (samePose)
+        {
+            changeMask = changes.getMask();
+            tileSize = changes.getTileSize();
+        }
+        lastPose = cameraPose;
+        hasLastPose = true;
+    }
+    const bool useMask = !changeMask.empty();
+
+    frameIndex++;
+    visibleBlocks.clear();
+
+    const cv::Matx33f rotation(cameraPose(0, 0), cameraPose(0, 1), cameraPose(0, 2),
+                               cameraPose(1, 0), cameraPose(1, 1), cameraPose(1, 2),
+                               cameraPose(2, 0), cameraPose(2, 1), cameraPose(2, 2));
+    const cv::Vec3f translation(cameraPose(0, 3), cameraPose(1, 3), cameraPose(2, 3));
+
+    const float blockLength = params.voxelSize * BLOCK_SIZE;
+    const float truncation = params.truncation;
+
+    // 1. 沿每条观测光线在截断带内收集候选块: 按行带并行，每个行带写自己的候选列表并去重
+    const int stride = std::max(1, params.pixelStride);
+    const int rowCount = (depthImg.rows + stride - 1) / stride;
+    const int bandCount = std::min(rowCount, std::max(1, cv::getNumThreads()) * 4);
+    candidateKeys.resize(bandCount);
+
+    cv::parallel_for_(cv::Range(0, bandCount), [&](const cv::Range &range)
+    {
+        for (int band = range.start; band < range.end; band++)
+        {
+            std::vector<uint64_t> &keys = candidateKeys[band];
+            keys.clear();
+            uint64_t lastKey = ~0ull;
+
+            for (int r = band * rowCount / bandCount; r < (band + 1) * rowCount / bandCount; r++)
+            {
+                const int v = r * stride;
+                const uint16_t *depthRow = depthImg.ptr<uint16_t>(v);
+                const uchar *maskRow = useMask ? changeMask.ptr<uchar>(v / tileSize) : nullptr;
+                for (int u = 0; u < depthImg.cols; u += stride)
+                {
+                    if (useMask && !maskRow[u / tileSize])
+                    {
+                        continue;
+                    }
+
+                    float depth = depthRow[u] * depthScale;
+                    if (depth < params.minDepth || depth > params.maxDepth)
+                    {
+                        continue;
+                    }
+
+                    cv::Vec3f ray((u - cx) / fx, (v - cy) / fy, 1.0f);
+                    cv::Vec3f start = rotation * (ray * (depth - truncation)) + translation;
+                    cv::Vec3f end = rotation * (ray * (depth + truncation)) + translation;
+                    cv::Vec3f segment = end - start;
+                    int steps = (int)std::ceil(cv::norm(segment) / (blockLength * 0.5f)) + 1;
+
+                    for (int i = 0; i <= steps; i++)
+                    {
+                        cv::Vec3f point = start + segment * ((float)i / steps);
+                        uint64_t key = packKey((int)std::floor(point[0] / blockLength),
+                                               (int)std::floor(point[1] / blockLength),
+                                               (int)std::floor(point[2] / blockLength));
+                        // 相邻采样点大多落在同一块，先过滤连续重复
+                        if (key != lastKey)
+                        {
+                            keys.push_back(key);
+                            lastKey = key;
+                        }
+                    }
+                }
+            }
+
+            std::sort(keys.begin(), keys.end());
+            keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        }
+    });
+
+    // 合并各行带的候选块并去重，只对不重复的块查找或分配
+    mergedKeys.clear();
+    for (int band = 0; band < bandCount; band++)
+    {
+        mergedKeys.insert(mergedKeys.end(), candidateKeys[band].begin(), candidateKeys[band].end());
+    }
+    std::sort(mergedKeys.begin(), mergedKeys.end());
+    mergedKeys.erase(std::unique(mergedKeys.begin(), mergedKeys.end()), mergedKeys.end());
+
+    for (size_t i = 0; i < mergedKeys.size(); i++)
+    {
+        int index = allocateBlock(mergedKeys[i]);
+        if (index >= 0 && blockLastVisible[index] != frameIndex)
+        {
+            blockLastVisible[index] = frameIndex;
+            visibleBlocks.push_back(index);
+        }
+    }
+
+    // 2. 并行融合可见块，每个块只写自己的体素
+    const cv::Matx33f rotationInv = rotation.t();
+    const cv::Vec3f translationInv = -(rotationInv * translation);
+    const float voxelSize = params.voxelSize;
+    const float minDepth = params.minDepth;
+    const float maxDepth = params.maxDepth;
+    const int maxWeight = params.maxWeight;
+    const int width = depthImg.cols;
+    const int height = depthImg.rows;
+
+    cv::parallel_for_(cv::Range(0, (int)visibleBlocks.size()), [&](const cv::Range &range)
+    {
+        for (int b = range.start; b < range.end; b++)
+        {
+            int blockIndex = visibleBlocks[b];
+            int bx, by, bz;
+            unpackKey(blockKeys[blockIndex], bx, by, bz);
+            Voxel *voxels = &voxelPool[(size_t)blockIndex * BLOCK_VOXELS];
+
+            for (int lz = 0; lz < BLOCK_SIZE; lz++)
+            {
+                for (int ly = 0; ly < BLOCK_SIZE; ly++)
+                {
+                    for (int lx = 0; lx < BLOCK_SIZE; lx++)
+                    {
+                        cv::Vec3f world((bx * BLOCK_SIZE + lx + 0.5f) * voxelSize,
+                                        (by * BLOCK_SIZE + ly + 0.5f) * voxelSize,
+                                        (bz * BLOCK_SIZE + lz + 0.5f) * voxelSize);
+                        cv::Vec3f camera = rotationInv * world + translationInv;
+                        if (camera[2] <= 0)
+                        {
+                            continue;
+                        }
+
+                        int u = (int)(fx * camera[0] / camera[2] + cx + 0.5f);
+                        int v = (int)(fy * camera[1] / camera[2] + cy + 0.5f);
+                        if (u < 0 || v < 0 || u >= width || v >= height)
+                        {
+                            continue;
+                        }
+                        if (useMask && !changeMask.at<uchar>(v / tileSize, u / tileSize))
+                        {
+                            continue;
+                        }
+
+                        float depth = depthImg.at<uint16_t>(v, u) * depthScale;
+                        if (depth < minDepth || depth > maxDepth)
+                        {
+                            continue;
+                        }
+
+                        float sdf = depth - camera[2];
+                        if (sdf < -truncation)
+                        {
+                            continue;
+                        }
+                        float tsdf = std::min(1.0f, sdf / truncation);
+
+                        // 加权平均更新
+                        Voxel &voxel = voxels[(lz * BLOCK_SIZE + ly) * BLOCK_SIZE + lx];
+                        int weight = voxel.weight;
+                        float oldTsdf = voxel.tsdf / kTsdfScale;
+                        float newTsdf = (oldTsdf * weight + tsdf) / (weight + 1);
+                        voxel.tsdf = (int16_t)std::lround(newTsdf * kTsdfScale);
+
+                        if (useColor)
+                        {
+                            const cv::Vec3b &bgr = colorImg.at<cv::Vec3b>(v, u);
+                            for (int c = 0; c < 3; c++)
+                            {
+                                voxel.color[c] = (uint8_t)((voxel.color[c] * weight + bgr[c]) / (weight + 1));
+                            }
+                        }
+                        voxel.weight = (uint16_t)std::min(weight + 1, maxWeight);
+                    }
+                }
+            }
+        }
+    });
+
+    return true;
+}
+
+/**
+ * @brief 光线投射生成指定视角的深度和彩色图像
+ */
+void TsdfVolume::raycast(const OBCameraIntrinsic &intrinsic, const cv::Matx44f &cameraPose,
+                         cv::Mat &depthImg, cv::Mat &colorImg) const
+{
+    const int width = intrinsic.width;
+    const int height = intrinsic.height;
+    depthImg.create(height, width, CV_32FC1);
+    colorImg.create(height, width, CV_8UC3);
+    depthImg.setTo(0);
+    colorImg.setTo(cv::Scalar::all(0));
+    if (width <= 0 || height <= 0 || intrinsic.fx <= 0 || intrinsic.fy <= 0)
+    {
+        return;
+    }
+
+    const cv::Matx33f rotation(cameraPose(0, 0), cameraPose(0, 1), cameraPose(0, 2),
+                               cameraPose(1, 0), cameraPose(1, 1), cameraPose(1, 2),
+                               cameraPose(2, 0), cameraPose(2, 1), cameraPose(2, 2));
+    const cv::Vec3f origin(cameraPose(0, 3), cameraPose(1, 3), cameraPose(2, 3));
+    const float voxelSize = params.voxelSize;
+    const float blockLength = voxelSize * BLOCK_SIZE;
+    const float truncation = params.truncation;
+
+    cv::parallel_for_(cv::Range(0, height), [&](const cv::Range &range)
+    {
+        for (int v = range.start; v < range.end; v++)
+        {
+            float *depthRow = depthImg.ptr<float>(v);
+            cv::Vec3b *colorRow = colorImg.ptr<cv::Vec3b>(v);
+            for (int u = 0; u < width; u++)
+            {
+                // t为相机坐标系下的z深度
+                cv::Vec3f direction = rotation * cv::Vec3f((u - intrinsic.cx) / intrinsic.fx,
+                                                           (v - intrinsic.cy) / intrinsic.fy, 1.0f);
+                float stepScale = 1.0f / (float)cv::norm(direction);
+
+                float t = params.minDepth;
+                float previousTsdf = 0.0f;
+                float previousT = 0.0f;
+                bool hasPrevious = false;
+
+                while (t < params.maxDepth)
+                {
+                    cv::Vec3f point = origin + direction * t;
+                    const Voxel *voxel = findVoxel((int)std::floor(point[0] / voxelSize),
+                                                   (int)std::floor(point[1] / voxelSize),
+                                                   (int)std::floor(point[2] / voxelSize));
+                    if (!voxel || voxel->weight == 0)
+                    {
+                        // 未分配区域按块长跳过
+                        hasPrevious = false;
+                        t += (voxel ? voxelSize : blockLength) * stepScale;
+                        continue;
+                    }
+
+                    float tsdf = voxel->tsdf / kTsdfScale;
+                    if (hasPrevious && previousTsdf > 0 && tsdf <= 0)
+                    {
+                        // 过零点线性插值
+                        float surfaceT = previousT + (t - previousT) * previousTsdf / (previousTsdf - tsdf);
+                        cv::Vec3f surface = origin + direction * surfaceT;
+                        const Voxel *surfaceVoxel = findVoxel((int)std::floor(surface[0] / voxelSize),
+                                                              (int)std::floor(surface[1] / voxelSize),
+                                                              (int)std::floor(surface[2] / voxelSize));
+                        depthRow[u] = surfaceT;
+                        if (surfaceVoxel)
+                        {
+                            colorRow[u] = cv::Vec3b(surfaceVoxel->color[0], surfaceVoxel->color[1], surfaceVoxel->color[2]);
+                        }
+                        break;
+                    }
+                    if (hasPrevious && previousTsdf < 0 && tsdf < 0)
+                    {
+                        // 从背面进入，不存在可见表面
+                        break;
+                    }
+
+                    previousTsdf = tsdf;
+                    previousT = t;
+                    hasPrevious = true;
+
+                    // 远离表面时按截断距离前进，接近表面时按体素前进
+                    float step = std::max(voxelSize, tsdf * truncation * 0.8f);
+                    t += step * stepScale;
+                }
+            }
+        }
+    });
+}
+
+/**
+ * @brief 提取表面网格并保存为PLY文件
+ */
+bool TsdfVolume::exportMesh(const std::string &filename) const
+{
+    std::vector<cv::Vec3f> vertices;
+    std::vector<cv::Vec3b> colors;
+    std::vector<cv::Vec3i> faces;
+    std::unordered_map<uint64_t, int> cellVertex;
+    const float voxelSize = params.voxelSize;
+
+    // 获取单元格 (以体素中心为角点) 的表面顶点，Surface Nets: 取边交点的平均
+    auto getCellVertex = [&](int x, int y, int z) -> int
+    {
+        uint64_t key = packKey(x, y, z);
+        auto it = cellVertex.find(key);
+        if (it != cellVertex.end())
+        {
+            return it->second;
+        }
+
+        float values[8];
+        const Voxel *corner0 = nullptr;
+        int index = -1;
+        bool valid = true;
+        for (int i = 0; i < 8 && valid; i++)
+        {
+            const Voxel *voxel = findVoxel(x + (i & 1), y + ((i >> 1) & 1), z + ((i >> 2) & 1));
+            if (!voxel || voxel->weight == 0)
+            {
+                valid = false;
+                break;
+            }
+            values[i] = voxel->tsdf / kTsdfScale;
+            if (i == 0)
+            {
+                corner0 = voxel;
+            }
+        }
+
+        if (valid)
+        {
+            cv::Vec3f sum(0, 0, 0);
+            int count = 0;
+            for (int i = 0; i < 8; i++)
+            {
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    int j = i | (1 << axis);
+                    if (j == i || (values[i] > 0) == (values[j] > 0))
+                    {
+                        continue;
+                    }
+                    float t = values[i] / (values[i] - values[j]);
+                    cv::Vec3f point((float)(i & 1), (float)((i >> 1) & 1), (float)((i >> 2) & 1));
+                    point[axis] += t;
+                    sum += point;
+                    count++;
+                }
+            }
+            if (count > 0)
+            {
+                cv::Vec3f local = sum * (1.0f / count);
+                index = (int)vertices.size();
+                vertices.push_back(cv::Vec3f((x + local[0] + 0.5f) * voxelSize,
+                                             (y + local[1] + 0.5f) * voxelSize,
+                                             (z + local[2] + 0.5f) * voxelSize));
+                colors.push_back(cv::Vec3b(corner0->color[2], corner0->color[1], corner0->color[0]));
+            }
+        }
+
+        cellVertex.emplace(key, index);
+        return index;
+    };
+
+    // 每条跨越零点的体素边生成一个四边形，连接共享该边的4个单元格顶点
+    for (size_t b = 0; b < usedBlocks; b++)
+    {
+        int bx, by, bz;
+        unpackKey(blockKeys[b], bx, by, bz);
+        const Voxel *voxels = &voxelPool[b * BLOCK_VOXELS];
+
+        for (int lz = 0; lz < BLOCK_SIZE; lz++)
+        {
+            for (int ly = 0; ly < BLOCK_SIZE; ly++)
+            {
+                for (int lx = 0; lx < BLOCK_SIZE; lx++)
+                {
+                    const Voxel &voxel = voxels[(lz * BLOCK_SIZE + ly) * BLOCK_SIZE + lx];
+                    if (voxel.weight == 0)
+                    {
+                        continue;
+                    }
+                    int x = bx * BLOCK_SIZE + lx;
+                    int y = by * BLOCK_SIZE + ly;
+                    int z = bz * BLOCK_SIZE + lz;
+                    bool outside = voxel.tsdf > 0;
+
+                    for (int axis = 0; axis < 3; axis++)
+                    {
+                        const Voxel *neighbor = findVoxel(x + (axis == 0), y + (axis == 1), z + (axis == 2));
+                        if (!neighbor || neighbor->weight == 0 || (neighbor->tsdf > 0) == outside)
+                        {
+                            continue;
+                        }
+
+                        // 其余两轴按循环顺序 (y,z) (z,x) (x,y) 围绕该边排列单元格
+                        static const int offsets[4][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+                        int quad[4];
+                        bool complete = true;
+                        for (int k = 0; k < 4 && complete; k++)
+                        {
+                            int cell[3] = {x, y, z};
+                            cell[(axis + 1) % 3] -= offsets[k][0];
+                            cell[(axis + 2) % 3] -= offsets[k][1];
+                            quad[k] = getCellVertex(cell[0], cell[1], cell[2]);
+                            complete = quad[k] >= 0;
+                        }
+                        if (!complete)
+                        {
+                            continue;
+                        }
+
+                        // 法线指向TSDF为正的一侧 (相机侧)
+                        if (outside)
+                        {
+                            faces.push_back(cv::Vec3i(quad[0], quad[3], quad[2]));
+                            faces.push_back(cv::Vec3i(quad[0], quad[2], quad[1]));
+                        }
+                        else
+                        {
+                            faces.push_back(cv::Vec3i(quad[0], quad[1], quad[2]));
+                            faces.push_back(cv::Vec3i(quad[0], quad[2], quad[3]));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file)
+    {
+        std::cerr << "TsdfVolume: cannot open " << filename << " for writing" << std::endl;
+        return false;
+    }
+
+    file << "ply\n"
+         << "format binary_little_endian 1.0\n"
+         << "element vertex " << vertices.size() << "\n"
+         << "property float x\n"
+         << "property float y\n"
+         << "property float z\n"
+         << "property uchar red\n"
+         << "property uchar green\n"
+         << "property uchar blue\n"
+         << "element face " << faces.size() << "\n"
+         << "property list uchar int vertex_indices\n"
+         << "end_header\n";
+
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        file.write((const char *)vertices[i].val, 3 * sizeof(float));
+        file.write((const char *)colors[i].val, 3);
+    }
+    const uint8_t faceSize = 3;
+    for (size_t i = 0; i < faces.size(); i++)
+    {
+        file.write((const char *)&faceSize, 1);
+        file.write((const char *)faces[i].val, 3 * sizeof(int));
+    }
+
+    std::cout << "Mesh saved as: " << filename << " (" << vertices.size() << " vertices, "
+              << faces.size() << " faces)" << std::endl;
+    return (bool)file;
+}
+
+/**
+ * @brief 获取已分配的体素块数量
+ */
+size_t TsdfVolume::getBlockCount() const
+{
+    return usedBlocks;
+}
+
+/**
+ * @brief 获取因块预算不足而未分配的体素块数量
+ */
+size_t TsdfVolume::getDroppedBlockCount() const
+{
+    return droppedBlocks;
+}
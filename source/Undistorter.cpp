@@ -0,0 +1,141 @@
+/**
+ * @file Undistorter.cpp
+ * @author Guo1ZY 132872017@qq.com
+ * @brief 预计算定点去畸变映射实现
+ * @version 0.1
+ * @date 2025-01-15
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "Undistorter.hpp"
+#include <algorithm>
+
+/**
+ * @brief 构造函数
+ */
+Undistorter::Undistorter(int interpolation)
+    : interpolation(interpolation), configured(false), intrinsic(), distortion()
+{
+}
+
+/**
+ * @brief 设置相机内参和畸变系数
+ */
+void Undistorter::setParams(const OBCameraIntrinsic &intrinsic, const OBCameraDistortion &distortion)
+{
+    this->intrinsic = intrinsic;
+    this->distortion = distortion;
+    configured = intrinsic.fx > 0 && intrinsic.fy > 0;
+
+    // 参数变化后重新生成映射表
+    mapSize = cv::Size();
+    map1.release();
+    map2.release();
+}
+
+/**
+ * @brief 是否已设置相机参数
+ */
+bool Undistorter::isConfigured() const
+{
+    return configured;
+}
+
+/**
+ * @brief 设置输出缓冲池容量
+ */
+void Undistorter::setPoolSize(size_t size)
+{
+    bufferPool.setCapacity(size);
+}
+
+/**
+ * @brief 按图像尺寸生成映射表
+ */
+void Undistorter::ensureMaps(const cv::Size &imageSize)
+{
+    if (imageSize == mapSize && !map1.empty())
+    {
+        return;
+    }
+
+    // 内参标定分辨率与输出分辨率不同时按比例缩放
+    OBCameraIntrinsic scaled = scaleIntrinsic(intrinsic, imageSize);
+    cv::Matx33d cameraMatrix(scaled.fx, 0, scaled.cx,
+                             0, scaled.fy, scaled.cy,
+                             0, 0, 1);
+
+    // OpenCV系数顺序: k1 k2 p1 p2 k3 k4 k5 k6
+    cv::Mat distCoeffs = (cv::Mat_<double>(1, 8) << distortion.k1, distortion.k2, distortion.p1, distortion.p2,
+                          distortion.k3, distortion.k4, distortion.k5, distortion.k6);
+
+    cv::Mat mapX, mapY;
+    cv::initUndistortRectifyMap(cameraMatrix, distCoeffs, cv::noArray(), cameraMatrix, imageSize,
+                                CV_32FC1, mapX, mapY);
+
+    // 转为定点格式; 最近邻模式四舍五入到整数坐标，不生成插值表
+    bool nearest = interpolation == cv::INTER_NEAREST;
+    cv::convertMaps(mapX, mapY, map1, map2, CV_16SC2, nearest);
+
+    mapSize = imageSize;
+}
+
+/**
+ * @brief 图像去畸变
+ */
+cv::Mat Undistorter::undistort(const cv::Mat &src)
+{
+    if (!configured || src.empty())
+    {
+        return src.clone();
+    }
+
+    ensureMaps(src.size());
+    cv::Mat dst = bufferPool.acquire(src.size(), src.type());
+
+    // 按行分块并行remap，每块只写自己的输出行
+    const int rows = src.rows;
+    const int tileCount = std::max(1, std::min(rows / 16, cv::getNumThreads() * 4));
+    const int tileRows = (rows + tileCount - 1) / tileCount;
+    const int interp = interpolation;
+    const cv::Mat &m1 = map1;
+    const cv::Mat &m2 = map2;
+
+    cv::parallel_for_(cv::Range(0, tileCount), [&](const cv::Range &range)
+    {
+        for (int tile = range.start; tile < range.end; tile++)
+        {
+            int rowBegin = tile * tileRows;
+            int rowEnd = std::min(rows, rowBegin + tileRows);
+            if (rowBegin >= rowEnd)
+            {
+                continue;
+            }
+
+            cv::Mat dstTile = dst.rowRange(rowBegin, rowEnd);
+            cv::Mat map1Tile = m1.rowRange(rowBegin, rowEnd);
+            cv::Mat map2Tile = m2.empty() ? cv::Mat() : m2.rowRange(rowBegin, rowEnd);
+            cv::remap(src, dstTile, map1Tile, map2Tile, interp, cv::BORDER_CONSTANT, cv::Scalar());
+        }
+    });
+
+    return dst;
+}
+
+/**
+ * @brief 查询去畸变图像中像素对应的原始图像像素
+ */
+bool Undistorter::mapPoint(const cv::Size &imageSize, int x, int y, int &srcX, int &srcY)
+{
+    if (!configured || x < 0 || y < 0 || x >= imageSize.width || y >= imageSize.height)
+    {
+        return false;
+    }
+
+    ensureMaps(imageSize);
+    const cv::Vec2s &point = map1.at<cv::Vec2s>(y, x);
+    srcX = point[0];
+    srcY = point[1];
+    return srcX >= 0 && srcY >= 0 && srcX < imageSize.width && srcY < imageSize.height;
+}
@@ -0,0 +1,206 @@
+/**
+ * @file VirtualScan.cpp
+ * @author Guo1ZY 132872017@qq.com
+ * @brief 深度图转虚拟二维激光扫描实现
+ * @version 0.1
+ * @date 2025-01-15
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "VirtualScan.hpp"
+#include "ImageUtils.hpp"
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+/**
+ * @brief 构造函数
+ */
+VirtualScan::VirtualScan(const VirtualScanParams &params)
+    : params(params), intrinsic(), tableScale(0.0f)
+{
+}
+
+/**
+ * @brief 设置扫描参数
+ */
+void VirtualScan::setParams(const VirtualScanParams &params)
+{
+    this->params = params;
+    tableSize = cv::Size();
+}
+
+/**
+ * @brief 设置相机内参
+ */
+void VirtualScan::setIntrinsic(const OBCameraIntrinsic &intrinsic)
+{
+    // 内参未变化时保留查找表
+    if (std::memcmp(&this->intrinsic, &intrinsic, sizeof(OBCameraIntrinsic)) == 0)
+    {
+        return;
+    }
+    this->intrinsic = intrinsic;
+    tableSize = cv::Size();
+}
+
+/**
+ * @brief 按图像尺寸和深度缩放重建查找表
+ */
+void VirtualScan::buildTables(const cv::Size &imageSize, float depthScale)
+{
+    // 内参标定分辨率与深度图分辨率不同时按比例缩放
+    OBCameraIntrinsic scaled = scaleIntrinsic(intrinsic, imageSize);
+    const float fx = scaled.fx;
+    const float fy = scaled.fy;
+    const float cx = scaled.cx;
+    const float cy = scaled.cy;
+
+    // 每行: 高度 = (cy - v) / fy * z，解出高度带对应的z范围
+    const float zLimit = std::min(params.rangeMax, 65535.0f * depthScale);
+    rowMin.resize(imageSize.height);
+    rowMax.resize(imageSize.height);
+    for (int v = 0; v < imageSize.height; v++)
+    {
+        float slope = (cy - v) / fy;
+        float zLow = 0.0f;
+        float zHigh = zLimit;
+        if (slope > 0)
+        {
+            zLow = std::max(zLow, params.minHeight / slope);
+            zHigh = std::min(zHigh, params.maxHeight / slope);
+        }
+        else if (slope < 0)
+        {
+            zLow = std::max(zLow, params.maxHeight / slope);
+            zHigh = std::min(zHigh, params.minHeight / slope);
+        }
+        else if (params.minHeight > 0 || params.maxHeight < 0)
+        {
+            zHigh = -1.0f;
+        }
+
+        // 原始深度0为无效值，下限至少为1
+        float low = std::max(1.0f, std::ceil(zLow / depthScale));
+        float high = std::floor(zHigh / depthScale);
+        if (high < low)
+        {
+            rowMin[v] = 1;
+            rowMax[v] = 0;
+        }
+        else
+        {
+            rowMin[v] = (uint16_t)std::min(low, 65535.0f);
+            rowMax[v] = (uint16_t)std::min(high, 65535.0f);
+        }
+    }
+
+    // 每列: 角度向左为正，水平距离 = z * sqrt(1 + x^2)
+    // 距离范围换算为每列的原始深度上下限，在取最小值之前过滤，避免过近的像素遮挡后方障碍物
+    columnAngle.resize(imageSize.width);
+    columnRangeFactor.resize(imageSize.width);
+    columnLow.resize(imageSize.width);
+    columnHigh.resize(imageSize.width);
+    for (int u = 0; u < imageSize.width; u++)
+    {
+        float x = (u - cx) / fx;
+        columnAngle[u] = -std::atan(x);
+        columnRangeFactor[u] = std::sqrt(1.0f + x * x) * depthScale;
+
+        // 0xFFFF用作无效标记，上限不超过65534
+        float low = std::max(1.0f, std::ceil(params.rangeMin / columnRangeFactor[u]));
+        float high = std::min(65534.0f, std::floor(params.rangeMax / columnRangeFactor[u]));
+        columnLow[u] = (uint16_t)std::min(low, 65535.0f);
+        columnHigh[u] = high < low ? 0 : (uint16_t)high;
+    }
+
+    columnMin.resize(imageSize.width);
+    tableSize = imageSize;
+    tableScale = depthScale;
+}
+
+/**
+ * @brief 深度图转换为激光扫描
+ */
+bool VirtualScan::convert(const cv::Mat &depthImg, LaserScan &scan, float depthScale)
+{
+    if (depthImg.empty() || depthImg.type() != CV_16UC1)
+    {
+        std::cerr << "VirtualScan: depth image must be a non-empty CV_16UC1 image" << std::endl;
+        return false;
+    }
+    if (intrinsic.fx <= 0 || intrinsic.fy <= 0)
+    {
+        std::cerr << "VirtualScan: camera intrinsic not set" << std::endl;
+        return false;
+    }
+
+    if (depthImg.size() != tableSize || depthScale != tableScale)
+    {
+        buildTables(depthImg.size(), depthScale);
+    }
+
+    const int width = depthImg.cols;
+    uint16_t *minRow = columnMin.data();
+    std::fill(columnMin.begin(), columnMin.end(), (uint16_t)0xFFFF);
+
+    // 逐行在高度带内取每列最小深度，超出范围的像素替换为0xFFFF
+    for (int v = 0; v < depthImg.rows; v++)
+    {
+        const uint16_t low = rowMin[v];
+        const uint16_t high = rowMax[v];
+        if (low > high)
+        {
+            continue;
+        }
+
+        const uint16_t *depthRow = depthImg.ptr<uint16_t>(v);
+        const uint16_t *lowRow = columnLow.data();
+        const uint16_t *highRow = columnHigh.data();
+        int u = 0;
+#if CV_SIMD
+        // 有效范围为行高度带与列距离范围的交集
+        const int lanes = cv::v_uint16::nlanes;
+        const cv::v_uint16 vLow = cv::vx_setall_u16(low);
+        const cv::v_uint16 vHigh = cv::vx_setall_u16(high);
+        const cv::v_uint16 vInvalid = cv::vx_setall_u16(0xFFFF);
+        for (; u <= width - lanes; u += lanes)
+        {
+            cv::v_uint16 depth = cv::vx_load(depthRow + u);
+            cv::v_uint16 lower = cv::v_max(vLow, cv::vx_load(lowRow + u));
+            cv::v_uint16 upper = cv::v_min(vHigh, cv::vx_load(highRow + u));
+            cv::v_uint16 inBand = (depth >= lower) & (depth <= upper);
+            cv::v_uint16 candidate = cv::v_select(inBand, depth, vInvalid);
+            cv::v_store(minRow + u, cv::v_min(cv::vx_load(minRow + u), candidate));
+        }
+#endif
+        for (; u < width; u++)
+        {
+            uint16_t depth = depthRow[u];
+            if (depth >= low && depth <= high && depth >= lowRow[u] && depth <= highRow[u] && depth < minRow[u])
+            {
+                minRow[u] = depth;
+            }
+        }
+    }
+
+    // 输出按角度递增排列 (从右到左)
+    const float infinity = std::numeric_limits<float>::infinity();
+    scan.rangeMin = params.rangeMin;
+    scan.rangeMax = params.rangeMax;
+    scan.angles.resize(width);
+    scan.ranges.resize(width);
+    for (int i = 0; i < width; i++)
+    {
+        int u = width - 1 - i;
+        scan.angles[i] = columnAngle[u];
+        // 距离范围已在取最小值前过滤
+        scan.ranges[i] = minRow[u] == 0xFFFF ? infinity : minRow[u] * columnRangeFactor[u];
+    }
+
+    return true;
+}
@@ -0,0 +1,96 @@
+/**
+ * @file ChangeDetectorTest.cpp
+ * @author Guo1ZY 132872017@qq.com
+ * @brief 分块变化检测测试
+ * @version 0.1
+ * @date 2025-01-15
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "ChangeDetector.hpp"
+#include <iostream>
+#include <string>
+
+namespace
+{
+    int failures = 0;
+
+    void check(bool ok, const std::string &name)
+    {
+        std::cout << (ok ? "[PASS] " : "[FAIL] ") << name << std::endl;
+        if (!ok)
+        {
+            failures++;
+        }
+    }
+
+    /**
+     * @brief 生成深度图: 背景1米，右下角32x32块为指定深度
+     */
+    cv::Mat makeDepth(int tileDepth)
+    {
+        cv::Mat depthImg(128, 128, CV_16UC1, cv::Scalar(1000));
+        depthImg(cv::Rect(96, 96, 32, 32)).setTo(cv::Scalar(tileDepth));
+        return depthImg;
+    }
+}
+
+int main()
+{
+    // 默认阈值: 深度高15mm、低8mm
+    {
+        ChangeDetector detector(32);
+        detector.update(cv::Mat(), makeDepth(1000));
+        detector.update(cv::Mat(), makeDepth(1000));
+        check(cv::countNonZero(detector.getMask()) == 0, "static scene unchanged");
+    }
+
+    // 每帧移动10mm (低于高阈值)，累积超过阈值后必须标记为变化
+    {
+        ChangeDetector detector(32);
+        // 首帧全部视为变化，第二帧后块稳定为未变化
+        detector.update(cv::Mat(), makeDepth(1000));
+        detector.update(cv::Mat(), makeDepth(1000));
+        int flippedAt = -1;
+        bool othersStatic = true;
+        for (int n = 1; n <= 30 && flippedAt < 0; n++)
+        {
+            const cv::Mat &mask = detector.update(cv::Mat(), makeDepth(1000 + 10 * n));
+            if (mask.at<uchar>(3, 3))
+            {
+                flippedAt = n;
+            }
+            othersStatic = othersStatic && cv::countNonZero(mask) == (mask.at<uchar>(3, 3) ? 1 : 0);
+        }
+        check(flippedAt == 2 && othersStatic, "slow ramp flips the tile once the total drift exceeds the threshold");
+    }
+
+    // 变化后静止: 参考帧已刷新，块恢复为未变化
+    {
+        ChangeDetector detector(32);
+        detector.update(cv::Mat(), makeDepth(1000));
+        detector.update(cv::Mat(), makeDepth(1100));
+        bool changed = detector.getMask().at<uchar>(3, 3) != 0;
+        detector.update(cv::Mat(), makeDepth(1100));
+        check(changed && cv::countNonZero(detector.getMask()) == 0, "tile settles after the change stops");
+    }
+
+    // 彩色缓慢变亮，每帧低于高阈值
+    {
+        ChangeDetector detector(32);
+        cv::Mat colorImg(128, 128, CV_8UC3, cv::Scalar(100, 100, 100));
+        detector.update(colorImg, cv::Mat());
+        detector.update(colorImg, cv::Mat());
+        bool flipped = false;
+        for (int n = 1; n <= 10 && !flipped; n++)
+        {
+            colorImg(cv::Rect(0, 0, 32, 32)).setTo(cv::Scalar(100 + 5 * n, 100 + 5 * n, 100 + 5 * n));
+            flipped = detector.update(colorImg, cv::Mat()).at<uchar>(0, 0) != 0;
+        }
+        check(flipped, "slow color ramp flips the tile");
+    }
+
+    std::cout << (failures ? "FAILED: " : "All tests passed") << (failures ? std::to_string(failures) : "") << std::endl;
+    return failures ? 1 : 0;
+}
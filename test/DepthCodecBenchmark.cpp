@@ -0,0 +1,108 @@
+/**
+ * @file DepthCodecBenchmark.cpp
+ * @author Guo1ZY 132872017@qq.com
+ * @brief 深度图编解码性能对比: RVL vs PNG
+ * @version 0.1
+ * @date 2025-01-15
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "DepthCodec.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+namespace
+{
+    const int kIterations = 20;
+
+    double elapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /**
+     * @brief 读取录制的深度帧 (16位PNG或.rvl)
+     */
+    bool loadFrame(DepthCodec &codec, const std::string &filename, cv::Mat &depthImg)
+    {
+        if (filename.size() > 4 && filename.compare(filename.size() - 4, 4, ".rvl") == 0)
+        {
+            return codec.load(filename, depthImg);
+        }
+        depthImg = cv::imread(filename, cv::IMREAD_ANYDEPTH);
+        return !depthImg.empty() && depthImg.type() == CV_16UC1;
+    }
+}
+
+/**
+ * @brief 用法: depth_codec_benchmark frame1.png [frame2.rvl ...]
+ *
+ * 输入为录制的深度帧，例如事件回溯保存的 *_depth.rvl 或 16位PNG。
+ */
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <depth frame .png/.rvl> [...]" << std::endl;
+        return 1;
+    }
+
+    DepthCodec codec;
+    std::vector<uint8_t> rvlStream;
+    std::vector<uint8_t> pngStream;
+    cv::Mat decoded;
+
+    double rvlEncodeMs = 0, rvlDecodeMs = 0, pngEncodeMs = 0, pngDecodeMs = 0;
+    size_t rawBytes = 0, rvlBytes = 0, pngBytes = 0;
+    int frameCount = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        cv::Mat depthImg;
+        if (!loadFrame(codec, argv[i], depthImg))
+        {
+            std::cerr << "Skip " << argv[i] << ": not a 16-bit depth frame" << std::endl;
+            continue;
+        }
+
+        for (int n = 0; n < kIterations; n++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            codec.encode(depthImg, rvlStream);
+            rvlEncodeMs += elapsedMs(start);
+
+            start = std::chrono::steady_clock::now();
+            codec.decode(rvlStream, decoded);
+            rvlDecodeMs += elapsedMs(start);
+
+            start = std::chrono::steady_clock::now();
+            cv::imencode(".png", depthImg, pngStream);
+            pngEncodeMs += elapsedMs(start);
+
+            start = std::chrono::steady_clock::now();
+            decoded = cv::imdecode(pngStream, cv::IMREAD_ANYDEPTH);
+            pngDecodeMs += elapsedMs(start);
+        }
+
+        rawBytes += depthImg.total() * sizeof(uint16_t);
+        rvlBytes += rvlStream.size();
+        pngBytes += pngStream.size();
+        frameCount++;
+    }
+
+    if (frameCount == 0)
+    {
+        std::cerr << "No valid depth frames" << std::endl;
+        return 1;
+    }
+
+    double runs = (double)frameCount * kIterations;
+    std::cout << "Frames: " << frameCount << " x " << kIterations << " iterations" << std::endl;
+    std::cout << "RVL  encode " << rvlEncodeMs / runs << " ms, decode " << rvlDecodeMs / runs
+              << " ms, ratio " << (double)rawBytes / rvlBytes << std::endl;
+    std::cout << "PNG  encode " << pngEncodeMs / runs << " ms, decode " << pngDecodeMs / runs
+              << " ms, ratio " << (double)rawBytes / pngBytes << std::endl;
+    return 0;
+}
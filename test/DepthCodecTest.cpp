@@ -0,0 +1,109 @@
+/**
+ * @file DepthCodecTest.cpp
+ * @author Guo1ZY 132872017@qq.com
+ * @brief 深度图无损编解码往返测试
+ * @version 0.1
+ * @date 2025-01-15
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "DepthCodec.hpp"
+#include <iostream>
+#include <string>
+
+namespace
+{
+    int failures = 0;
+
+    /**
+     * @brief 编码后解码，检查与原图逐像素一致
+     */
+    void checkRoundTrip(DepthCodec &codec, const std::string &name, const cv::Mat &depthImg)
+    {
+        std::vector<uint8_t> stream;
+        cv::Mat decoded;
+        bool ok = codec.encode(depthImg, stream) && codec.decode(stream, decoded) &&
+                  decoded.size() == depthImg.size() && decoded.type() == CV_16UC1 &&
+                  cv::countNonZero(depthImg != decoded) == 0;
+
+        std::cout << (ok ? "[PASS] " : "[FAIL] ") << name << " (" << depthImg.cols << "x" << depthImg.rows
+                  << ", " << stream.size() << " bytes)" << std::endl;
+        if (!ok)
+        {
+            failures++;
+        }
+    }
+
+    /**
+     * @brief 生成近似真实场景的深度图: 平滑表面 + 噪声 + 无效空洞
+     */
+    cv::Mat makeSyntheticDepth(int width, int height)
+    {
+        cv::Mat depthImg(height, width, CV_16UC1);
+        cv::RNG rng(12345);
+        for (int v = 0; v < height; v++)
+        {
+            uint16_t *row = depthImg.ptr<uint16_t>(v);
+            for (int u = 0; u < width; u++)
+            {
+                int depth = 800 + u + v * 2 + rng.uniform(-3, 4);
+                row[u] = (uint16_t)depth;
+            }
+        }
+        cv::rectangle(depthImg, cv::Rect(width / 4, height / 4, width / 8, height / 3), cv::Scalar(0), cv::FILLED);
+        cv::rectangle(depthImg, cv::Rect(0, 0, width, 3), cv::Scalar(0), cv::FILLED);
+        return depthImg;
+    }
+}
+
+int main()
+{
+    DepthCodec codec;
+
+    checkRoundTrip(codec, "synthetic scene", makeSyntheticDepth(640, 480));
+    checkRoundTrip(codec, "synthetic scene 1280x720", makeSyntheticDepth(1280, 720));
+    checkRoundTrip(codec, "all zeros", cv::Mat::zeros(480, 640, CV_16UC1));
+    checkRoundTrip(codec, "all max", cv::Mat(480, 640, CV_16UC1, cv::Scalar(65535)));
+
+    // 全部非零且相邻像素差分最大 (1 <-> 65535交替)
+    cv::Mat maxDelta(480, 640, CV_16UC1);
+    for (int v = 0; v < maxDelta.rows; v++)
+    {
+        uint16_t *row = maxDelta.ptr<uint16_t>(v);
+        for (int u = 0; u < maxDelta.cols; u++)
+        {
+            row[u] = ((u + v) & 1) ? 65535 : 1;
+        }
+    }
+    checkRoundTrip(codec, "all non-zero, max deltas", maxDelta);
+
+    // 随机值，零值与非零值交错
+    cv::Mat random(480, 640, CV_16UC1);
+    cv::randu(random, cv::Scalar(0), cv::Scalar(65536));
+    random.setTo(0, random < 20000);
+    checkRoundTrip(codec, "random with zero runs", random);
+
+    // 非连续ROI
+    cv::Mat large = makeSyntheticDepth(800, 600);
+    cv::Mat roi = large(cv::Rect(37, 21, 501, 333));
+    checkRoundTrip(codec, "non-continuous ROI", roi);
+
+    checkRoundTrip(codec, "1x1", cv::Mat(1, 1, CV_16UC1, cv::Scalar(4321)));
+    checkRoundTrip(codec, "odd size 7x3", makeSyntheticDepth(7, 3));
+
+    // 截断的码流必须解码失败
+    std::vector<uint8_t> stream;
+    cv::Mat decoded;
+    codec.encode(makeSyntheticDepth(640, 480), stream);
+    stream.resize(stream.size() / 2);
+    bool truncatedRejected = !codec.decode(stream, decoded);
+    std::cout << (truncatedRejected ? "[PASS] " : "[FAIL] ") << "truncated stream rejected" << std::endl;
+    if (!truncatedRejected)
+    {
+        failures++;
+    }
+
+    std::cout << (failures ? "FAILED: " : "All tests passed") << (failures ? std::to_string(failures) : "") << std::endl;
+    return failures ? 1 : 0;
+}
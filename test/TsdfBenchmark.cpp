@@ -0,0 +1,123 @@
+/**
+ * @file TsdfBenchmark.cpp
+ * @author Guo1ZY 132872017@qq.com
+ * @brief TSDF融合性能测试
+ * @version 0.1
+ * @date 2025-01-15
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+#include "DepthCodec.hpp"
+#include "TsdfVolume.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+    const int kFrameCount = 60;
+    const double kFrameBudgetMs = 1000.0 / 30.0;
+
+    /**
+     * @brief 生成合成场景深度图: 2米处的墙面、地面和一个球体
+     */
+    cv::Mat makeSyntheticDepth(const OBCameraIntrinsic &intrinsic)
+    {
+        cv::Mat depthImg(intrinsic.height, intrinsic.width, CV_16UC1);
+        const cv::Vec3f center(0.2f, 0.1f, 1.5f);
+        const float radius = 0.3f;
+        for (int v = 0; v < depthImg.rows; v++)
+        {
+            uint16_t *row = depthImg.ptr<uint16_t>(v);
+            for (int u = 0; u < depthImg.cols; u++)
+            {
+                cv::Vec3f ray((u - intrinsic.cx) / intrinsic.fx, (v - intrinsic.cy) / intrinsic.fy, 1.0f);
+                float depth = 2.0f;
+
+                // 相机高0.5米的地面
+                if (ray[1] > 0)
+                {
+                    depth = std::min(depth, 0.5f / ray[1]);
+                }
+
+                // 射线与球求交 (深度为z分量)
+                float a = ray.dot(ray);
+                float b = -2.0f * ray.dot(center);
+                float c = center.dot(center) - radius * radius;
+                float discriminant = b * b - 4 * a * c;
+                if (discriminant >= 0)
+                {
+                    depth = std::min(depth, (-b - std::sqrt(discriminant)) / (2 * a));
+                }
+                row[u] = (uint16_t)(depth * 1000.0f);
+            }
+        }
+        return depthImg;
+    }
+}
+
+/**
+ * @brief 用法: tsdf_benchmark [depth1.rvl ...]
+ *
+ * 不带参数时使用1280x720合成场景 (与D2C对齐后的默认深度分辨率一致)，
+ * 带参数时依次融合录制的深度帧 (如事件回溯保存的 *_depth.rvl)。
+ */
+int main(int argc, char **argv)
+{
+    // 1280x720彩色相机的典型内参，录制帧按分辨率缩放
+    OBCameraIntrinsic intrinsic;
+    intrinsic.fx = 690.0f;
+    intrinsic.fy = 690.0f;
+    intrinsic.cx = 640.0f;
+    intrinsic.cy = 360.0f;
+    intrinsic.width = 1280;
+    intrinsic.height = 720;
+
+    std::vector<cv::Mat> frames;
+    DepthCodec codec;
+    for (int i = 1; i < argc; i++)
+    {
+        cv::Mat depthImg;
+        if (codec.load(argv[i], depthImg))
+        {
+            frames.push_back(depthImg);
+        }
+    }
+    if (frames.empty())
+    {
+        frames.push_back(makeSyntheticDepth(intrinsic));
+    }
+
+    TsdfVolume volume;
+    std::vector<double> times;
+    for (int n = 0; n < kFrameCount; n++)
+    {
+        // 相机缓慢平移，每帧都有新块需要分配
+        cv::Matx44f pose = cv::Matx44f::eye();
+        pose(0, 3) = 0.005f * n;
+
+        const cv::Mat &depthImg = frames[n % frames.size()];
+        auto start = std::chrono::steady_clock::now();
+        volume.integrate(depthImg, cv::Mat(), intrinsic, pose);
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    // 第一帧包含全部块的首次分配，单独报告
+    double first = times[0];
+    std::sort(times.begin() + 1, times.end());
+    double sum = 0;
+    for (size_t i = 1; i < times.size(); i++)
+    {
+        sum += times[i];
+    }
+    double mean = sum / (times.size() - 1);
+    double p95 = times[1 + (size_t)((times.size() - 2) * 0.95)];
+
+    std::cout << "Depth " << frames[0].cols << "x" << frames[0].rows << ", " << cv::getNumThreads() << " threads" << std::endl;
+    std::cout << "First frame: " << first << " ms" << std::endl;
+    std::cout << "integrate(): mean " << mean << " ms, p95 " << p95 << " ms, max " << times.back() << " ms" << std::endl;
+    std::cout << "Blocks: " << volume.getBlockCount() << ", dropped " << volume.getDroppedBlockCount() << std::endl;
+    std::cout << (mean <= kFrameBudgetMs ? "Within" : "Exceeds") << " 30 FPS budget (" << kFrameBudgetMs << " ms)" << std::endl;
+    return 0;
+}